@@ -12,6 +12,10 @@
 #define USB_RX_BUFSIZE USB_MAX_PACKET_SIZE
 #endif
 
+// USB_FRAMING_COBS: COBS frames with a CRC-16 (comms/cobs.hpp) instead of
+// bare length prefixed packets, so a corrupt or dropped byte only loses one
+// packet. Not defined by default, define it for the Pi and every Pico alike.
+
 #ifndef USB_DEBUG_ABSTRACTED
 #define USB_DEBUG_ABSTRACTED // default to the abstracted usb debug instead of sending raw text. undefine this to change.
 #endif
@@ -16,6 +16,7 @@ enum class SendIdentifiers : types::u8 {
 enum class RecvIdentifiers : types::u8 {
   MOTOR_DRIVER_CMD = 0,
   KICKER_CMD = 1,
+  MOTOR_DRIVER_CMD_ALL = 2, // all four motors at once
   PING = 253,
   BOARD_ID = 254,
   BLINK = 255,
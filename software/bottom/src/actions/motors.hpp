@@ -15,6 +15,14 @@ struct MotorRecvData {
   i16 duty_cycle;
 } __attribute__((packed));
 
+// MOTOR_DRIVER_CMD_ALL, every motor from one update of the pi
+// ^ SYNC WITH THE PI (libs/motors/include/motors.hpp) ^
+struct MotorAllRecvData {
+  u32 sequence;     // +1 per update, 0 never sent (empty buffer)
+  u64 timestamp_ns; // pi clock, when sent
+  i16 duty_cycles[MOTOR_COUNT]; // by motor id - 1
+} __attribute__((packed));
+
 static TaskHandle_t motor_task_handle = nullptr;
 static driver::MotorDriver driver1;
 static driver::MotorDriver driver2;
@@ -22,7 +30,11 @@ static driver::MotorDriver driver3;
 static driver::MotorDriver driver4;
 static MotorRecvData motor_task_data = {};
 static u8 motor_task_buffer[sizeof(motor_task_data)];
+static MotorAllRecvData motor_all_task_data = {};
+static u8 motor_all_task_buffer[sizeof(motor_all_task_data)];
+// guards both buffers, both listeners notify motor_task
 static SemaphoreHandle_t motor_data_mutex = nullptr;
+static u32 last_motor_sequence = 0;
 
 // static i16 current_duty_cycles[4] = {0};
 // static i16 target_duty_cycles[4] = {0};
@@ -86,8 +98,15 @@ void motor_task(void *args) {
     xSemaphoreTake(motor_data_mutex, portMAX_DELAY);
     memcpy(&motor_task_data, motor_task_buffer, sizeof(motor_task_data));
     memset(motor_task_buffer, 0, sizeof(motor_task_buffer));
+    memcpy(&motor_all_task_data, motor_all_task_buffer,
+           sizeof(motor_all_task_data));
+    memset(motor_all_task_buffer, 0, sizeof(motor_all_task_buffer));
     xSemaphoreGive(motor_data_mutex);
+
+    // a single motor (id 0 is an empty buffer)
     switch (motor_task_data.id) {
+    case 0:
+      break;
     case 1:
       driver1.command(motor_task_data.duty_cycle);
       break;
@@ -104,5 +123,21 @@ void motor_task(void *args) {
       debug::error("Invalid motor ID: %d\n", motor_task_data.id);
       break;
     }
+
+    // all motors, back to back in this one wakeup
+    if (motor_all_task_data.sequence) {
+      if (last_motor_sequence &&
+          motor_all_task_data.sequence != last_motor_sequence + 1) {
+        debug::warn("Motor updates skipped: %u -> %u\n",
+                    (unsigned)last_motor_sequence,
+                    (unsigned)motor_all_task_data.sequence);
+      }
+      last_motor_sequence = motor_all_task_data.sequence;
+
+      driver1.command(motor_all_task_data.duty_cycles[0]);
+      driver2.command(motor_all_task_data.duty_cycles[1]);
+      driver3.command(motor_all_task_data.duty_cycles[2]);
+      driver4.command(motor_all_task_data.duty_cycles[3]);
+    }
   }
 }
@@ -46,11 +46,16 @@ void main_task(void *args) {
       comms::RecvIdentifiers::MOTOR_DRIVER_CMD, motor_task_handle,
       motor_data_mutex, motor_task_buffer, sizeof(motor_task_data));
 
+  bool motor_all_attach_successful = comms::USB_CDC.attach_listener(
+      comms::RecvIdentifiers::MOTOR_DRIVER_CMD_ALL, motor_task_handle,
+      motor_data_mutex, motor_all_task_buffer, sizeof(motor_all_task_data));
+
   bool kicker_attach_successful = comms::USB_CDC.attach_listener(
       comms::RecvIdentifiers::KICKER_CMD, kicker_task_handle, kicker_mutex,
       kicker_task_buffer, sizeof(kicker_task_data));
 
-  // if (!motor_attach_successful || !kicker_attach_successful) {
+  // if (!motor_attach_successful || !motor_all_attach_successful ||
+  //     !kicker_attach_successful) {
   //   comms::USB_CDC.write(comms::SendIdentifiers::COMMS_ERROR, NULL, 0);
   //   vTaskDelete(main_task_handle);
   // }
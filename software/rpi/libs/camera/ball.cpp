@@ -1,5 +1,6 @@
 #include "ball.hpp"
 #include "config.hpp"
+#include "segmentation.hpp"
 
 BallDetector::BallDetector(const cv::Point& centerPoint, int minContourArea, int minBrightness, bool debug)
     : m_centerPoint(centerPoint),
@@ -36,8 +37,6 @@ bool BallDetector::detectBall(const cv::Mat& frame, cv::Point& ballPosition, dou
 
 std::vector<IRPoint> BallDetector::detectIRPoints(const cv::Mat& frame, cv::Mat& irMask)
 {
-    std::vector<IRPoint> irPoints;
-    
     // Convert to HSV colorspace
     cv::Mat hsv;
     cv::cvtColor(frame, hsv, cv::COLOR_BGR2HSV);
@@ -54,6 +53,21 @@ std::vector<IRPoint> BallDetector::detectIRPoints(const cv::Mat& frame, cv::Mat&
     // Combine masks - we want purple AND bright
     cv::bitwise_and(purpleMask, brightMask, irMask);
     
+    return findIRPoints(irMask);
+}
+
+std::vector<IRPoint> BallDetector::detectIRPointsFromLabels(const cv::Mat& labels, cv::Mat& irMask)
+{
+    // Purple AND bright is a single class of the label image
+    camera::Segmenter::mask(labels, camera::CLASS_IR, irMask);
+    
+    return findIRPoints(irMask);
+}
+
+std::vector<IRPoint> BallDetector::findIRPoints(cv::Mat& irMask)
+{
+    std::vector<IRPoint> irPoints;
+    
     // Apply minimal morphology to clean up the mask
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
     cv::morphologyEx(irMask, irMask, cv::MORPH_OPEN, kernel);
@@ -15,6 +15,11 @@ Camera::~Camera() {
         camera_->stop();
     }
 
+    // ^ any FrameHandle still alive now dangles
+    for (auto &mapping : mappings_) {
+        munmap(mapping.first, mapping.second);
+    }
+
     allocator_.reset();
     camera_.reset();
     cameraManager_.reset();
@@ -78,7 +83,8 @@ bool Camera::initialize(camera::Resolutions resolution) {
     config_->at(0).size.height = height_;
     config_->at(0).pixelFormat =
         libcamera::formats::RGB888; // Format compatible with OpenCV
-    config_->at(0).bufferCount = 4; // Multiple buffers for performance
+    config_->at(0).bufferCount =
+        CAMERA_BUFFER_COUNT; // Multiple buffers for performance
 
     // Apply configuration
     ret = camera_->configure(config_.get());
@@ -104,7 +110,9 @@ bool Camera::initialize(camera::Resolutions resolution) {
         allocator_->buffers(stream);
 
     for (unsigned int i = 0; i < buffers.size(); ++i) {
-        std::unique_ptr<libcamera::Request> request = camera_->createRequest();
+        // the cookie is the index of the request's frame
+        std::unique_ptr<libcamera::Request> request =
+            camera_->createRequest(i);
         if (!request) {
             std::cerr << "Failed to create request" << std::endl;
             return false;
@@ -118,6 +126,15 @@ bool Camera::initialize(camera::Resolutions resolution) {
             return false;
         }
 
+        // Map the buffer once, frames wrap it for as long as we live
+        std::unique_ptr<Frame> frame = std::make_unique<Frame>();
+        frame->owner   = this;
+        frame->context = request.get();
+        if (!mapFrame(*frame, fb.get(), config_->at(0).stride)) {
+            return false;
+        }
+
+        frames_.push_back(std::move(frame));
         requests_.push_back(std::move(request));
     }
 
@@ -126,6 +143,15 @@ bool Camera::initialize(camera::Resolutions resolution) {
 }
 
 bool Camera::startCapture(FrameProcessor processor) {
+    if (!processor) {
+        return startStreaming(nullptr);
+    }
+
+    return startStreaming(
+        [processor](FrameHandle frame) { processor(frame.image()); });
+}
+
+bool Camera::startStreaming(FrameSink sink) {
     if (running_) {
         std::cerr << "Camera is already running" << std::endl;
         return false;
@@ -136,16 +162,10 @@ bool Camera::startCapture(FrameProcessor processor) {
         return false;
     }
 
-    frameProcessor_ = processor;
+    frameSink_ = std::move(sink);
 
-    // Clear any existing frames
-    {
-        std::unique_lock<std::mutex> lock(frameMutex_);
-        while (!frameQueue_.empty()) {
-            frameQueue_.pop();
-        }
-        latestFrame_ = cv::Mat();
-    }
+    // Clear any existing frame
+    mailbox_.clear();
 
     // Start camera
     int ret = camera_->start();
@@ -157,13 +177,16 @@ bool Camera::startCapture(FrameProcessor processor) {
     // Set up completion callback
     camera_->requestCompleted.connect(this, &Camera::requestComplete);
 
-    // Queue initial requests
-    for (auto &request : requests_) {
-        camera_->queueRequest(request.get());
-    }
-
     running_ = true;
 
+    // Queue initial requests, frames still held from a previous run are
+    // queued when released
+    for (auto &frame : frames_) {
+        if (frame->refcount.load(std::memory_order_acquire) == 0) {
+            queueFrame(frame.get());
+        }
+    }
+
     // Start capture thread
     captureThread_ = std::thread(&Camera::captureThreadFunc, this);
 
@@ -183,7 +206,9 @@ void Camera::stopCapture() {
         captureThread_.join();
     }
 
-    if (camera_ && isRunning()) {
+    // running_ is already false here, stop unconditionally (cancels the
+    // queued requests, held frames are re-queued on the next start)
+    if (camera_) {
         camera_->stop();
     }
 
@@ -192,90 +217,101 @@ void Camera::stopCapture() {
 
 bool Camera::isRunning() const { return running_; }
 
-cv::Mat Camera::getLatestFrame() const {
-    std::unique_lock<std::mutex> lock(frameMutex_);
-    return latestFrame_.clone();
-}
+FrameHandle Camera::getLatestFrame() const { return mailbox_.latest(); }
 
 void Camera::captureThreadFunc() {
+    uint64_t lastSequence = 0;
+
     while (running_) {
-        std::unique_lock<std::mutex> lock(frameMutex_);
-        if (frameQueue_.empty()) {
+        // Always jump to the newest frame, older ones are counted as skipped
+        FrameHandle frame = mailbox_.takeNewer(lastSequence);
+        if (!frame) {
             // Wait for a frame or stop signal
-            frameCondition_.wait_for(
-                lock, std::chrono::milliseconds(100),
-                [this] { return !frameQueue_.empty() || !running_; });
-
-            if (!running_) {
-                break;
-            }
-
-            if (frameQueue_.empty()) {
-                continue;
-            }
+            std::unique_lock<std::mutex> lock(frameMutex_);
+            frameCondition_.wait_for(lock, std::chrono::milliseconds(100),
+                                     [this, lastSequence] {
+                                         return mailbox_.hasNewer(
+                                                    lastSequence) ||
+                                                !running_;
+                                     });
+            continue;
         }
 
-        // Get next frame from queue
-        cv::Mat frame = frameQueue_.front();
-        frameQueue_.pop();
-
-        // Update latest frame
-        latestFrame_ = frame.clone();
-
-        // Release lock before processing
-        lock.unlock();
-
         // Process frame if callback provided
-        if (frameProcessor_) {
-            frameProcessor_(frame);
+        if (frameSink_) {
+            frameSink_(std::move(frame));
         }
+
+        // dropping the handle hands the buffer back once nobody else holds it
     }
 }
 
 void Camera::requestComplete(libcamera::Request *request) {
+    Frame *frame = frames_[request->cookie()].get();
+    frame->queued.store(false, std::memory_order_release);
+
     if (request->status() == libcamera::Request::RequestCancelled) {
         return;
     }
 
-    // Get frame buffer from completed request
+    // Get frame buffer from completed request, sequences start at 1 so that
+    // 0 means "nothing seen yet"
     const libcamera::Stream *stream = config_->at(0).stream();
     libcamera::FrameBuffer *buffer  = request->buffers().at(stream);
+    frame->sequence                 = buffer->metadata().sequence + 1;
 
-    // Convert to OpenCV Mat
-    cv::Mat frame = convertToMat(buffer);
+    // the sensor timestamp is CLOCK_BOOTTIME, fall back to the buffer's
+    auto sensorTimestamp =
+        request->metadata().get(libcamera::controls::SensorTimestamp);
+    frame->timestamp_ns =
+        sensorTimestamp ? *sensorTimestamp : buffer->metadata().timestamp;
 
-    // Add to frame queue
-    {
-        std::unique_lock<std::mutex> lock(frameMutex_);
-        // Limit queue size - discard oldest frames if queue gets too large
-        if (frameQueue_.size() > 10) {
-            frameQueue_.pop();
-        }
-        frameQueue_.push(frame);
-        frameCondition_.notify_one();
-    }
+    // Replaces the previous frame, which is re-queued once nobody holds it
+    mailbox_.publish(FrameHandle(frame));
+
+    // the lock is only held by the waiter between its check and its sleep,
+    // taking it here makes sure the wakeup cannot fall into that gap
+    { std::lock_guard<std::mutex> lock(frameMutex_); }
+    frameCondition_.notify_one();
+}
 
+void Camera::recycle(Frame *frame) {
     // Re-queue request for continuous capture
-    request->reuse();
-    request->addBuffer(stream, buffer);
+    if (running_) {
+        queueFrame(frame);
+    }
+}
+
+void Camera::queueFrame(Frame *frame) {
+    // a frame can be released while startCapture is queueing, only queue once
+    if (frame->queued.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    libcamera::Request *request =
+        static_cast<libcamera::Request *>(frame->context);
+    request->reuse(libcamera::Request::ReuseBuffers);
     camera_->queueRequest(request);
 }
 
-cv::Mat Camera::convertToMat(libcamera::FrameBuffer *buffer) {
+bool Camera::mapFrame(Frame &frame, libcamera::FrameBuffer *buffer,
+                      unsigned int stride) {
     // Get the first plane (RGB data is in a single plane for RGB888 format)
     const libcamera::FrameBuffer::Plane &plane = buffer->planes()[0];
 
-    // Map the buffer memory
-    void *data = mmap(nullptr, plane.length, PROT_READ, MAP_SHARED, plane.fd.get(), 0);
+    // Map the whole dmabuf, the plane may not start at offset 0
+    size_t length = plane.offset + plane.length;
+    void *data =
+        mmap(nullptr, length, PROT_READ, MAP_SHARED, plane.fd.get(), 0);
 
     if (data == MAP_FAILED) {
         std::cerr << "Failed to mmap buffer" << std::endl;
-        return cv::Mat();
+        return false;
     }
+    mappings_.push_back({data, length});
 
-    cv::Mat image(height_, width_, CV_8UC3, data);
-    cv::Mat result = image.clone();
-    munmap(data, plane.length);
-    return result;
+    frame.image = cv::Mat(height_, width_, CV_8UC3,
+                          static_cast<uint8_t *>(data) + plane.offset, stride);
+    return true;
 }
 } // namespace camera
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "field_tables.hpp"
+#include "config.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace camera {
+namespace field_tables {
+
+namespace {
+
+// * the field model, generated at compile time
+constexpr auto LEVEL_0_POINTS =
+    field_model::sample_lines<FIELD_MODEL_POINTS[0]>();
+constexpr auto LEVEL_1_POINTS =
+    field_model::sample_lines<FIELD_MODEL_POINTS[1]>();
+constexpr auto LEVEL_2_POINTS =
+    field_model::sample_lines<FIELD_MODEL_POINTS[2]>();
+constexpr auto LEVEL_3_POINTS =
+    field_model::sample_lines<FIELD_MODEL_POINTS[3]>();
+constexpr auto CHUNKS = field_model::occupied_cells<CHUNK_SIZE>();
+
+static_assert(sizeof(FIELD_MODEL_POINTS) / sizeof(FIELD_MODEL_POINTS[0]) ==
+                  PYRAMID_LEVELS,
+              "one point count per pyramid level");
+
+struct RotatedPointTable {
+    std::vector<int16_t> x[HEADING_BINS];
+    std::vector<int16_t> y[HEADING_BINS];
+    RotatedPoints views[HEADING_BINS];
+
+    /**
+     * @param level Pyramid level, points are scaled down by 2^level and
+     * de-duplicated after rotating
+     */
+    template <size_t N>
+    RotatedPointTable(const std::array<field_model::Point, N> &points,
+                      int level = 0) {
+        std::vector<std::pair<int16_t, int16_t>> rotated(N);
+
+        for (int bin = 0; bin < HEADING_BINS; bin++) {
+            double heading = bin * 2 * M_PI / HEADING_BINS;
+            int32_t sin_fp = static_cast<int32_t>(sin(heading) * FP_ONE);
+            int32_t cos_fp = static_cast<int32_t>(cos(heading) * FP_ONE);
+
+            int shift = FP_SHIFT + level;
+            for (size_t i = 0; i < N; i++) {
+                int32_t px = points[i].x;
+                int32_t py = points[i].y;
+                rotated[i] = {(px * cos_fp - py * sin_fp) >> shift,
+                              (px * sin_fp + py * cos_fp) >> shift};
+            }
+
+            // sorted by image row, so lookups walk the image in order
+            std::sort(rotated.begin(), rotated.end());
+            auto end = std::unique(rotated.begin(), rotated.end());
+            for (auto it = rotated.begin(); it != end; it++) {
+                x[bin].push_back(it->first);
+                y[bin].push_back(it->second);
+            }
+
+            views[bin] = {x[bin].data(), y[bin].data(), (int)x[bin].size(),
+                          sin_fp, cos_fp};
+        }
+    }
+};
+
+} // namespace
+
+int heading_to_bin(float heading) {
+    int bin = static_cast<int>(
+                  lroundf(heading * (HEADING_BINS / (2 * (float)M_PI)))) %
+              HEADING_BINS;
+    return bin < 0 ? bin + HEADING_BINS : bin;
+}
+
+const RotatedPoints &white_lines(int heading_bin, int level) {
+    static const RotatedPointTable tables[PYRAMID_LEVELS] = {
+        {LEVEL_0_POINTS, 0},
+        {LEVEL_1_POINTS, 1},
+        {LEVEL_2_POINTS, 2},
+        {LEVEL_3_POINTS, 3},
+    };
+    static_assert(PYRAMID_LEVELS == 4, "one table per pyramid level");
+    return tables[level].views[heading_bin];
+}
+
+const RotatedPoints &white_chunks(int heading_bin) {
+    static const RotatedPointTable table(CHUNKS);
+    return table.views[heading_bin];
+}
+
+} // namespace field_tables
+} // namespace camera
@@ -0,0 +1,69 @@
+#include "frame_mailbox.hpp"
+
+namespace camera {
+
+void FrameMailbox::publish(FrameHandle frame) {
+    uint64_t sequence = frame.sequence();
+
+    Frame* old = slot_.exchange(frame.release(), std::memory_order_acq_rel);
+    latestSequence_.store(sequence, std::memory_order_release);
+    published_.fetch_add(1, std::memory_order_relaxed);
+
+    if (old) {
+        // old is still pinned by the slot's reference until adopted below
+        if (old->sequence > lastTaken_.load(std::memory_order_relaxed)) {
+            overwritten_.fetch_add(1, std::memory_order_relaxed);
+        }
+        FrameHandle::adopt(old).reset();
+    }
+}
+
+FrameHandle FrameMailbox::latest() const {
+    while (true) {
+        Frame* frame = slot_.load(std::memory_order_acquire);
+        if (!frame) {
+            return FrameHandle();
+        }
+
+        // frames are never freed, so pinning a replaced one is safe, it just
+        // fails (recycled) or is stale (retry for the newer one)
+        FrameHandle handle = FrameHandle::tryPin(frame);
+        if (handle && slot_.load(std::memory_order_acquire) == frame) {
+            return handle;
+        }
+    }
+}
+
+FrameHandle FrameMailbox::takeNewer(uint64_t& lastSequence) {
+    if (!hasNewer(lastSequence)) {
+        return FrameHandle();
+    }
+
+    FrameHandle handle = latest();
+    if (!handle || handle.sequence() <= lastSequence) {
+        return FrameHandle();
+    }
+
+    if (lastSequence != 0) {
+        skipped_.fetch_add(handle.sequence() - lastSequence - 1,
+                           std::memory_order_relaxed);
+    }
+    lastSequence = handle.sequence();
+
+    uint64_t taken = lastTaken_.load(std::memory_order_relaxed);
+    while (taken < lastSequence &&
+           !lastTaken_.compare_exchange_weak(taken, lastSequence,
+                                             std::memory_order_relaxed)) {
+    }
+
+    return handle;
+}
+
+void FrameMailbox::clear() {
+    Frame* old = slot_.exchange(nullptr, std::memory_order_acq_rel);
+    if (old) {
+        FrameHandle::adopt(old).reset();
+    }
+}
+
+} // namespace camera
@@ -1,15 +1,17 @@
 #include "goalpost.hpp"
+#include "config.hpp"
+#include "segmentation.hpp"
 
 GoalpostDetector::GoalpostDetector(bool debug) : m_debug(debug) {
     // Initialize HSV color thresholds
-    BLUE_LOWER = cv::Scalar(100, 50, 50);
-    BLUE_UPPER = cv::Scalar(150, 255, 255);
+    BLUE_LOWER = camera::GOALPOST_BLUE_LOWER;
+    BLUE_UPPER = camera::GOALPOST_BLUE_UPPER;
 
-    YELLOW_LOWER = cv::Scalar(20, 137, 110);
-    YELLOW_UPPER = cv::Scalar(30, 255, 255);
+    YELLOW_LOWER = camera::GOALPOST_YELLOW_LOWER;
+    YELLOW_UPPER = camera::GOALPOST_YELLOW_UPPER;
 
-    FIELD_LOWER = cv::Scalar(35, 50, 50);
-    FIELD_UPPER = cv::Scalar(85, 255, 255);
+    FIELD_LOWER = camera::FIELD_COLOR_LOWER;
+    FIELD_UPPER = camera::FIELD_COLOR_UPPER;
 
     // Initialize parameters
     MIN_CONTOUR_AREA   = 400;
@@ -27,6 +29,34 @@ void GoalpostDetector::setCenterPoint(const cv::Point &center) {
 
 std::pair<GoalpostInfo, GoalpostInfo>
 GoalpostDetector::detectGoalposts(const cv::Mat &frame, cv::Mat *outputFrame) {
+    // Convert to HSV color space
+    cv::Mat hsv;
+    cv::cvtColor(frame, hsv, cv::COLOR_BGR2HSV);
+
+    // Create color masks
+    cv::Mat blueMask, yellowMask;
+    cv::inRange(hsv, BLUE_LOWER, BLUE_UPPER, blueMask);
+    cv::inRange(hsv, YELLOW_LOWER, YELLOW_UPPER, yellowMask);
+
+    return detectGoalpostsFromMasks(frame, blueMask, yellowMask, outputFrame);
+}
+
+std::pair<GoalpostInfo, GoalpostInfo>
+GoalpostDetector::detectGoalposts(const cv::Mat &frame, const cv::Mat &labels,
+                                  cv::Mat *outputFrame) {
+    // Color masks straight from the label image
+    cv::Mat blueMask, yellowMask;
+    camera::Segmenter::mask(labels, camera::CLASS_BLUE, blueMask);
+    camera::Segmenter::mask(labels, camera::CLASS_YELLOW, yellowMask);
+
+    return detectGoalpostsFromMasks(frame, blueMask, yellowMask, outputFrame);
+}
+
+std::pair<GoalpostInfo, GoalpostInfo>
+GoalpostDetector::detectGoalpostsFromMasks(const cv::Mat &frame,
+                                           cv::Mat &blueMask,
+                                           cv::Mat &yellowMask,
+                                           cv::Mat *outputFrame) {
 
     // Initialize result structures
     GoalpostInfo blueGoalInfo   = {false};
@@ -39,15 +69,6 @@ GoalpostDetector::detectGoalposts(const cv::Mat &frame, cv::Mat *outputFrame) {
         cv::circle(output, m_centerPoint, 5, cv::Scalar(255, 255, 255), -1);
     }
 
-    // Convert to HSV color space
-    cv::Mat hsv;
-    cv::cvtColor(frame, hsv, cv::COLOR_BGR2HSV);
-
-    // Create color masks
-    cv::Mat blueMask, yellowMask;
-    cv::inRange(hsv, BLUE_LOWER, BLUE_UPPER, blueMask);
-    cv::inRange(hsv, YELLOW_LOWER, YELLOW_UPPER, yellowMask);
-
     // Apply morphology
     cv::Mat kernelSmall =
         cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
@@ -27,6 +27,9 @@ public:
 
     // Additional functions for debugging and visualization
     std::vector<IRPoint> detectIRPoints(const cv::Mat& frame, cv::Mat& irMask);
+    // Same as detectIRPoints, using a label image from camera::Segmenter
+    // (which uses the config brightness, not setMinBrightness)
+    std::vector<IRPoint> detectIRPointsFromLabels(const cv::Mat& labels, cv::Mat& irMask);
     void drawDebugInfo(cv::Mat& outputFrame, const std::vector<IRPoint>& points, const cv::Point* strongestPoint = nullptr);
     cv::Mat createDebugView(const cv::Mat& frame, const cv::Mat& irMask, const std::vector<IRPoint>& points, const cv::Point* strongestPoint = nullptr);
 
@@ -49,6 +52,7 @@ private:
     cv::Scalar m_purpleUpper;
 
     // Helper functions
+    std::vector<IRPoint> findIRPoints(cv::Mat& irMask);
     double calculateDistance(const cv::Point& p1, const cv::Point& p2);
     double calculateAngle(const cv::Point& point);
     cv::Point findStrongestIRSource(const std::vector<IRPoint>& irPoints);
@@ -8,13 +8,16 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
-#include <queue>
 #include "config.hpp"
+#include "frame.hpp"
+#include "frame_mailbox.hpp"
 
 namespace camera {
-class Camera {
+class Camera : public FrameOwner {
 public:
     using FrameProcessor = std::function<void(const cv::Mat&)>;
+    // gets the handle itself, to keep the buffer past the call (pipelines)
+    using FrameSink = std::function<void(FrameHandle)>;
     
     Camera();
     ~Camera();
@@ -25,14 +28,24 @@ public:
     // Start capturing frames with optional processing callback
     bool startCapture(FrameProcessor processor = nullptr);
     
+    // Start capturing frames, handing each frame's handle to sink
+    bool startStreaming(FrameSink sink);
+    
     // Stop capturing frames
     void stopCapture();
     
     // Check if camera is running
     bool isRunning() const;
     
-    // Get the latest captured frame
-    cv::Mat getLatestFrame() const;
+    // Get the latest captured frame (no copy, the handle pins the buffer)
+    FrameHandle getLatestFrame() const;
+    
+    // Frames replaced before anyone took them / skipped by the capture thread
+    uint64_t overwrittenFrames() const { return mailbox_.overwritten(); }
+    uint64_t skippedFrames() const { return mailbox_.skipped(); }
+    
+    // Takes a frame back once its last handle is dropped
+    void recycle(Frame* frame) override;
     
 private:
     // LibCamera objects
@@ -45,13 +58,16 @@ private:
     // Capture state
     std::atomic<bool> running_{false};
     std::thread captureThread_;
-    FrameProcessor frameProcessor_;
+    FrameSink frameSink_;
     
     // Frame management
-    mutable std::mutex frameMutex_;
+    // one Frame per buffer / request, mapped once in initialize()
+    std::vector<std::unique_ptr<Frame>> frames_;
+    std::vector<std::pair<void*, size_t>> mappings_;
+    // latest frame wins, requestComplete never waits on a consumer
+    FrameMailbox mailbox_;
+    std::mutex frameMutex_; // only guards the condition variable's wait
     std::condition_variable frameCondition_;
-    std::queue<cv::Mat> frameQueue_;
-    cv::Mat latestFrame_;
     
     // Camera configuration
     int width_;
@@ -60,6 +76,7 @@ private:
     // Private methods
     void captureThreadFunc();
     void requestComplete(libcamera::Request* request);
-    cv::Mat convertToMat(libcamera::FrameBuffer* buffer);
+    bool mapFrame(Frame& frame, libcamera::FrameBuffer* buffer, unsigned int stride);
+    void queueFrame(Frame* frame);
 };
 }
\ No newline at end of file
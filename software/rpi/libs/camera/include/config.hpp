@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <opencv2/core/types.hpp>
 namespace camera {
 enum Resolutions { RES_1232P = 0, RES_1080P = 1, RES_480P = 2 };
@@ -11,6 +12,18 @@ const int BALL_DETECTION_MIN_BRIGHTNESS = 130;
 const int BALL_DETECTION_HEADING_TOL = 15;
 const cv::Scalar BALL_DETECTION_PURPLE_MASK_LOWER(130, 50, 100);
 const cv::Scalar BALL_DETECTION_PURPLE_MASK_UPPER(175, 255, 255);
+
+// goalpost detection (HSV)
+const cv::Scalar GOALPOST_BLUE_LOWER(100, 50, 50);
+const cv::Scalar GOALPOST_BLUE_UPPER(150, 255, 255);
+const cv::Scalar GOALPOST_YELLOW_LOWER(20, 137, 110);
+const cv::Scalar GOALPOST_YELLOW_UPPER(30, 255, 255);
+// GoalpostDetector angle to the robot frame (CamProcessor::detect_goalposts)
+const float GOALPOST_ANGLE_OFFSET = M_PI / 2;
+
+// field (green) colour (HSV)
+const cv::Scalar FIELD_COLOR_LOWER(35, 50, 50);
+const cv::Scalar FIELD_COLOR_UPPER(85, 255, 255);
  
 // thresholds for white
 const int COLOR_R_THRES = 160;
@@ -21,11 +34,29 @@ const int COLOR_B_THRES = 160;
 const int IMG_WIDTH  = 480;
 const int IMG_HEIGHT = 640;
 
-// full search
-const int FULL_SEARCH_STEP                  = 5;
-const int FULL_SEARCH_HEADING_STEP          = 5;
-const int FULL_SEARCH_INTERVAL              = 120;
-const int FULL_SEARCH_WHITE_COUNT_THRESHOLD = 5;
+// capture buffers, every frame held by a consumer pins one of these
+const int CAMERA_BUFFER_COUNT = 6;
+
+// distance map (chamfer loss)
+// distances are clamped to this many pixels, so a point this far or further
+// from any white line contributes a full loss of 1
+const int DISTANCE_MAP_MAX_DIST = 20;
+
+// field model, points sampled along the lines per pyramid level
+// (field_tables), the loss of a pose costs one lookup per point
+// ^ TO BE TUNED
+constexpr int FIELD_MODEL_POINTS[] = {1000, 600, 300, 150};
+
+// full search (coarse level of relocalization)
+const int FULL_SEARCH_STEP         = 8; // one coarse level pixel
+const int FULL_SEARCH_HEADING_STEP = 5;
+const int FULL_SEARCH_INTERVAL     = 120;
+
+// relocalization
+const int RELOCALIZATION_COARSE_LEVEL   = 3; // 1/8 res, roughly a chunk
+const int RELOCALIZATION_MID_LEVEL      = 1; // 1/2 res
+const int RELOCALIZATION_CANDIDATES     = 16;
+const int RELOCALIZATION_TIME_BUDGET_US = 30000;
 
 // particle search
 const int PARTICLE_SEARCH_NUM      = 150;
@@ -40,4 +71,46 @@ const float REGRESSION_INITIAL_STEP_Y        = 3.0f;
 const float REGRESSION_INITIAL_STEP_HEADING  = 0.05f; // ~3 degrees
 const float REGRESSION_STEP_DECAY            = 0.7f;
 const float REGRESSION_CONVERGENCE_THRESHOLD = 0.001f;
+
+// position tracking (local grid search around the last pose)
+const int TRACKING_XY_VARIANCE        = 12;
+const int TRACKING_XY_STEP            = 3;
+const float TRACKING_HEADING_VARIANCE = 14 * M_PI / 180;
+const float TRACKING_HEADING_STEP     = 2 * M_PI / 180;
+
+// goalpost pose prior
+// ^ TO BE TUNED
+// goal centers (field units), blue on the -x side
+const float GOAL_BLUE_X   = -155.0f;
+const float GOAL_YELLOW_X = 155.0f;
+const float GOAL_Y        = 0.0f;
+// field units per GoalpostInfo::distance pixel
+// ! PLACEHOLDER, NOT CALIBRATED: the detector measures to the goal's bottom
+// ! edge through the mirror, 1.0 assumes the line model's 1 px = 1 unit. The
+// ! prior is unusable on hardware until this is fitted from logged frames.
+const float GOAL_DISTANCE_SCALE = 1.0f;
+const float GOAL_BEARING_STD    = 3 * M_PI / 180;
+const float GOAL_RANGE_STD      = 0.15f; // fraction of the range
+const float GOAL_RANGE_STD_MIN  = 3.0f;
+const float POSE_PRIOR_HEADING_STD = 5 * M_PI / 180; // IMU heading
+// searches seeded by a prior cover this many standard deviations
+const float POSE_PRIOR_SIGMAS = 3.0f;
+
+// heading constrained localization (IMU yaw)
+// ^ TO BE TUNED
+const float HEADING_CONSTRAINT_STD    = 3 * M_PI / 180; // fused yaw
+// searched band, in standard deviations either side
+const float HEADING_CONSTRAINT_SIGMAS = 2.0f;
+// soft constraint, loss added to a pose one standard deviation off
+const float HEADING_CONSTRAINT_WEIGHT = 0.02f;
+
+// vision pipeline
+// frames waiting between two stages, older ones are dropped past this
+const int VISION_QUEUE_DEPTH = 2;
+// cores the stage threads are pinned to, -1 to leave a stage unpinned
+const int VISION_SEGMENTATION_CORE = 0;
+const int VISION_GOALPOST_CORE     = 1;
+const int VISION_BALL_CORE         = 2;
+const int VISION_LOCALIZATION_CORE = 3;
+const int VISION_PUBLISH_CORE      = -1;
 } // namespace camera
\ No newline at end of file
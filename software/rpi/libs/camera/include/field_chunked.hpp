@@ -1,31 +0,0 @@
-// Auto-generated field chunk coordinates
-// Generated from: field.png
-// Chunk Size: 10x10 pixels
-// Coordinates represent the indices (cx, cy) of chunks containing white.
-#pragma once
-
-namespace camera {
-namespace field_chunked {
-
-constexpr int CHUNK_SIZE = 10;
-constexpr int FIELD_CHUNKS_WIDTH = 20;
-constexpr int FIELD_CHUNKS_HEIGHT = 16;
-constexpr int WHITE_CHUNK_COUNT = 92;
-
-constexpr int WHITE_CHUNK_INDICES[WHITE_CHUNK_COUNT][2] = {
-    {0, 0},   {1, 0},   {2, 0},   {3, 0},   {4, 0},   {5, 0},   {6, 0},
-    {7, 0},   {8, 0},   {9, 0},   {10, 0},  {11, 0},  {12, 0},  {13, 0},
-    {14, 0},  {15, 0},  {16, 0},  {17, 0},  {18, 0},  {19, 0},  {0, 1},
-    {19, 1},  {0, 2},   {19, 2},  {0, 3},   {1, 3},   {18, 3},  {19, 3},
-    {0, 4},   {1, 4},   {2, 4},   {16, 4},  {17, 4},  {18, 4},  {19, 4},
-    {0, 5},   {2, 5},   {16, 5},  {19, 5},  {0, 6},   {2, 6},   {16, 6},
-    {19, 6},  {0, 7},   {2, 7},   {16, 7},  {19, 7},  {0, 8},   {2, 8},
-    {16, 8},  {19, 8},  {0, 9},   {2, 9},   {16, 9},  {19, 9},  {0, 10},
-    {2, 10},  {16, 10}, {17, 10}, {19, 10}, {0, 11},  {1, 11},  {2, 11},
-    {17, 11}, {18, 11}, {19, 11}, {0, 12},  {19, 12}, {0, 13},  {19, 13},
-    {0, 14},  {19, 14}, {0, 15},  {1, 15},  {2, 15},  {3, 15},  {4, 15},
-    {5, 15},  {6, 15},  {7, 15},  {8, 15},  {9, 15},  {10, 15}, {11, 15},
-    {12, 15}, {13, 15}, {14, 15}, {15, 15}, {16, 15}, {17, 15}, {18, 15},
-    {19, 15}};
-}
-}
\ No newline at end of file
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Field line model, built at compile time from the field geometry, so that
+// every point set and occupancy grid shares one coordinate convention:
+// field units (320px = 200cm), origin at the field center, x towards the
+// yellow goal, y to the left of it.
+namespace camera {
+namespace field_model {
+
+// * geometry (field units, line centers)
+constexpr int HALF_LENGTH           = 155; // outer line, x
+constexpr int HALF_WIDTH            = 125; // outer line, y
+constexpr int PENALTY_X             = 115; // penalty area front line, |x|
+constexpr int PENALTY_HALF_WIDTH    = 62;  // penalty area side lines, |y|
+constexpr int PENALTY_CORNER_RADIUS = 12;  // rounded front corners
+
+constexpr double PI = 3.14159265358979323846;
+
+struct Segment {
+    double x0, y0, x1, y1;
+};
+
+// counter-clockwise from start to end (radians)
+struct Arc {
+    double cx, cy, radius, start, end;
+};
+
+constexpr double PENALTY_CORNER_Y = PENALTY_HALF_WIDTH - PENALTY_CORNER_RADIUS;
+constexpr double PENALTY_SIDE_X   = PENALTY_X + PENALTY_CORNER_RADIUS;
+
+constexpr Segment SEGMENTS[] = {
+    // outer boundary
+    {-HALF_LENGTH, -HALF_WIDTH, HALF_LENGTH, -HALF_WIDTH},
+    {HALF_LENGTH, -HALF_WIDTH, HALF_LENGTH, HALF_WIDTH},
+    {HALF_LENGTH, HALF_WIDTH, -HALF_LENGTH, HALF_WIDTH},
+    {-HALF_LENGTH, HALF_WIDTH, -HALF_LENGTH, -HALF_WIDTH},
+
+    // blue (-x) penalty area
+    {-PENALTY_X, -PENALTY_CORNER_Y, -PENALTY_X, PENALTY_CORNER_Y},
+    {-PENALTY_SIDE_X, -PENALTY_HALF_WIDTH, -HALF_LENGTH, -PENALTY_HALF_WIDTH},
+    {-PENALTY_SIDE_X, PENALTY_HALF_WIDTH, -HALF_LENGTH, PENALTY_HALF_WIDTH},
+
+    // yellow (+x) penalty area
+    {PENALTY_X, -PENALTY_CORNER_Y, PENALTY_X, PENALTY_CORNER_Y},
+    {PENALTY_SIDE_X, -PENALTY_HALF_WIDTH, HALF_LENGTH, -PENALTY_HALF_WIDTH},
+    {PENALTY_SIDE_X, PENALTY_HALF_WIDTH, HALF_LENGTH, PENALTY_HALF_WIDTH},
+};
+
+constexpr Arc ARCS[] = {
+    {-PENALTY_SIDE_X, PENALTY_CORNER_Y, PENALTY_CORNER_RADIUS, 0, PI / 2},
+    {-PENALTY_SIDE_X, -PENALTY_CORNER_Y, PENALTY_CORNER_RADIUS, 3 * PI / 2,
+     2 * PI},
+    {PENALTY_SIDE_X, PENALTY_CORNER_Y, PENALTY_CORNER_RADIUS, PI / 2, PI},
+    {PENALTY_SIDE_X, -PENALTY_CORNER_Y, PENALTY_CORNER_RADIUS, PI,
+     3 * PI / 2},
+};
+
+constexpr int NUM_SEGMENTS = sizeof(SEGMENTS) / sizeof(SEGMENTS[0]);
+constexpr int NUM_ARCS     = sizeof(ARCS) / sizeof(ARCS[0]);
+
+// * constexpr math (the <cmath> functions are not constexpr)
+
+constexpr double sqrt(double value) {
+    if (value <= 0) {
+        return 0;
+    }
+    // Newton's method, from above, until it stops decreasing
+    double root = value > 1 ? value : 1;
+    while (true) {
+        double next = 0.5 * (root + value / root);
+        if (next >= root) {
+            return root;
+        }
+        root = next;
+    }
+}
+
+// Taylor series, after reducing the angle to [-pi, pi]
+constexpr double sin(double angle) {
+    while (angle > PI) {
+        angle -= 2 * PI;
+    }
+    while (angle < -PI) {
+        angle += 2 * PI;
+    }
+    double term = angle, sum = angle;
+    for (int n = 1; n < 12; n++) {
+        term *= -angle * angle / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double angle) { return sin(angle + PI / 2); }
+
+constexpr int floor(double value) {
+    int truncated = static_cast<int>(value);
+    return truncated > value ? truncated - 1 : truncated;
+}
+
+// halves away from zero, so the model stays symmetric about the center
+constexpr int round(double value) {
+    return value < 0 ? -floor(-value + 0.5) : floor(value + 0.5);
+}
+
+constexpr double segment_length(const Segment &s) {
+    return sqrt((s.x1 - s.x0) * (s.x1 - s.x0) + (s.y1 - s.y0) * (s.y1 - s.y0));
+}
+
+constexpr double arc_length(const Arc &a) { return a.radius * (a.end - a.start); }
+
+constexpr double total_length() {
+    double length = 0;
+    for (const Segment &s : SEGMENTS) {
+        length += segment_length(s);
+    }
+    for (const Arc &a : ARCS) {
+        length += arc_length(a);
+    }
+    return length;
+}
+
+struct Point {
+    int16_t x, y;
+};
+
+/**
+ * @brief Exact point at arc length distance along the lines, segments
+ * first, then arcs
+ */
+constexpr void point_at(double distance, double &x, double &y) {
+    for (const Segment &s : SEGMENTS) {
+        double length = segment_length(s);
+        if (distance < length) {
+            double t = distance / length;
+            x        = s.x0 + t * (s.x1 - s.x0);
+            y        = s.y0 + t * (s.y1 - s.y0);
+            return;
+        }
+        distance -= length;
+    }
+    for (const Arc &a : ARCS) {
+        double length = arc_length(a);
+        if (distance < length || &a == &ARCS[NUM_ARCS - 1]) {
+            double angle = a.start + distance / a.radius;
+            x            = a.cx + a.radius * cos(angle);
+            y            = a.cy + a.radius * sin(angle);
+            return;
+        }
+        distance -= length;
+    }
+}
+
+/**
+ * @brief N points evenly spaced along the lines (by arc length), rounded to
+ * whole field units
+ * Consecutive points are total_length() / N apart, so N sets the density of
+ * a level directly.
+ */
+template <int N> constexpr std::array<Point, N> sample_lines() {
+    static_assert(N > 0, "at least one point");
+    std::array<Point, N> points{};
+    double spacing = total_length() / N;
+    for (int i = 0; i < N; i++) {
+        double x = 0, y = 0;
+        point_at((i + 0.5) * spacing, x, y);
+        points[i] = {static_cast<int16_t>(round(x)),
+                     static_cast<int16_t>(round(y))};
+    }
+    return points;
+}
+
+/**
+ * @brief Cells of CELL x CELL field units covered by a line
+ * Cell (i, j) is centered on (i * CELL, j * CELL), so cells are symmetric
+ * about the field center and CELL = 1 matches the rounded points.
+ */
+template <int CELL> struct OccupancyGrid {
+    static_assert(CELL > 0, "cell size must be positive");
+
+    // largest cell index on each axis, indices run over [-MAX, MAX]
+    static constexpr int MAX_X  = (HALF_LENGTH + CELL / 2) / CELL + 1;
+    static constexpr int MAX_Y  = (HALF_WIDTH + CELL / 2) / CELL + 1;
+    static constexpr int WIDTH  = 2 * MAX_X + 1;
+    static constexpr int HEIGHT = 2 * MAX_Y + 1;
+
+    bool cells[HEIGHT][WIDTH] = {};
+    int count                 = 0;
+
+    static constexpr int cell_of(double value) {
+        return round(value / CELL);
+    }
+
+    constexpr bool occupied(int i, int j) const {
+        return i >= -MAX_X && i <= MAX_X && j >= -MAX_Y && j <= MAX_Y &&
+               cells[j + MAX_Y][i + MAX_X];
+    }
+
+    constexpr OccupancyGrid() {
+        // walk each line in steps well under a cell, marking every cell it
+        // passes through
+        const double step = 0.25;
+        for (const Segment &s : SEGMENTS) {
+            int steps = static_cast<int>(segment_length(s) / step) + 1;
+            for (int k = 0; k <= steps; k++) {
+                double t = static_cast<double>(k) / steps;
+                mark(s.x0 + t * (s.x1 - s.x0), s.y0 + t * (s.y1 - s.y0));
+            }
+        }
+        for (const Arc &a : ARCS) {
+            int steps = static_cast<int>(arc_length(a) / step) + 1;
+            for (int k = 0; k <= steps; k++) {
+                double angle = a.start + (a.end - a.start) * k / steps;
+                mark(a.cx + a.radius * cos(angle), a.cy + a.radius * sin(angle));
+            }
+        }
+    }
+
+  private:
+    constexpr void mark(double x, double y) {
+        bool &cell = cells[cell_of(y) + MAX_Y][cell_of(x) + MAX_X];
+        count += !cell;
+        cell = true;
+    }
+};
+
+/**
+ * @brief Indices (i, j) of the occupied cells of a grid, row by row
+ */
+template <int CELL, int COUNT = OccupancyGrid<CELL>().count>
+constexpr std::array<Point, COUNT> occupied_cells() {
+    using Grid = OccupancyGrid<CELL>;
+    constexpr Grid grid{};
+    std::array<Point, COUNT> points{};
+    int n = 0;
+    for (int j = -Grid::MAX_Y; j <= Grid::MAX_Y; j++) {
+        for (int i = -Grid::MAX_X; i <= Grid::MAX_X; i++) {
+            if (grid.occupied(i, j)) {
+                points[n++] = {static_cast<int16_t>(i),
+                               static_cast<int16_t>(j)};
+            }
+        }
+    }
+    return points;
+}
+
+} // namespace field_model
+} // namespace camera
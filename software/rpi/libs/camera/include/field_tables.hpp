@@ -0,0 +1,56 @@
+#pragma once
+
+#include "field_model.hpp"
+#include <cstdint>
+
+namespace camera {
+namespace field_tables {
+
+// heading resolution of the rotated tables (1 degree per bin)
+constexpr int HEADING_BINS = 360;
+
+// resolution levels of the tables, level n is scaled down by 2^n
+constexpr int PYRAMID_LEVELS = 4;
+
+// field units per chunk of the chunked loss
+constexpr int CHUNK_SIZE = 10;
+
+// Fixed-point scaling factor (Q16.16 format), same as the loss functions
+constexpr int FP_SHIFT = 16;
+constexpr int FP_ONE   = 1 << FP_SHIFT;
+
+/**
+ * @brief View of a field point set rotated to one heading bin
+ * Stored as structure of arrays, so the loss loops only translate and look up
+ */
+struct RotatedPoints {
+    const int16_t *x;
+    const int16_t *y;
+    int count;
+
+    // Q16.16 sin / cos of the bin, used to rotate the pose translation
+    int32_t sin_fp;
+    int32_t cos_fp;
+};
+
+/**
+ * @brief Quantize a heading (radians, any range) to its table bin
+ */
+int heading_to_bin(float heading);
+
+/**
+ * @brief The field model's line points rotated to a heading bin
+ * Level n samples FIELD_MODEL_POINTS[n] points along the lines, scaled down
+ * by 2^n to match a frame (or distance map) scaled down the same way
+ * ^ Tables are built once, on first use
+ */
+const RotatedPoints &white_lines(int heading_bin, int level = 0);
+
+/**
+ * @brief Occupied CHUNK_SIZE cells of the field model (chunk indices,
+ * centered like the points) rotated to a heading bin
+ */
+const RotatedPoints &white_chunks(int heading_bin);
+
+} // namespace field_tables
+} // namespace camera
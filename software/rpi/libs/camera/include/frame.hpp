@@ -0,0 +1,122 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace camera {
+
+struct Frame;
+
+/**
+ * @brief Hands out frames, and takes each back once its last handle is gone
+ */
+class FrameOwner {
+public:
+    virtual ~FrameOwner() = default;
+
+    // Called by the last FrameHandle of a frame, from whichever thread drops it
+    virtual void recycle(Frame* frame) = 0;
+};
+
+/**
+ * @brief One capture buffer, its image wraps the buffer memory directly
+ * ^ Never copied or moved, the owner keeps these for its whole lifetime
+ */
+struct Frame {
+    cv::Mat image;
+
+    // set by the owner, strictly increasing from 1 (gaps are dropped frames)
+    uint64_t sequence = 0;
+
+    // start of exposure, in timer::ns() time (CLOCK_BOOTTIME)
+    uint64_t timestamp_ns = 0;
+
+    FrameOwner* owner = nullptr;
+    std::atomic<int> refcount{0};
+
+    // owner bookkeeping (e.g. the libcamera request, and whether it is queued)
+    void* context = nullptr;
+    std::atomic<bool> queued{false};
+};
+
+/**
+ * @brief Reference counted handle to a Frame
+ * The frame (and its buffer) stays valid, and is not handed back to the
+ * camera, while any handle to it exists. Copying a handle does not copy the
+ * image.
+ */
+class FrameHandle {
+public:
+    FrameHandle() = default;
+
+    // Takes a new reference to frame
+    explicit FrameHandle(Frame* frame) : frame_(frame) {
+        if (frame_) {
+            frame_->refcount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    FrameHandle(const FrameHandle& other) : FrameHandle(other.frame_) {}
+
+    FrameHandle(FrameHandle&& other) noexcept : frame_(other.frame_) {
+        other.frame_ = nullptr;
+    }
+
+    FrameHandle& operator=(FrameHandle other) noexcept {
+        std::swap(frame_, other.frame_);
+        return *this;
+    }
+
+    ~FrameHandle() { reset(); }
+
+    // Wrap a reference the caller already owns (no increment)
+    static FrameHandle adopt(Frame* frame) {
+        FrameHandle handle;
+        handle.frame_ = frame;
+        return handle;
+    }
+
+    // Take a reference only if the frame is still referenced by someone,
+    // i.e. it has not been recycled. Empty on failure.
+    static FrameHandle tryPin(Frame* frame) {
+        int count = frame->refcount.load(std::memory_order_relaxed);
+        while (count > 0) {
+            if (frame->refcount.compare_exchange_weak(
+                    count, count + 1, std::memory_order_acquire,
+                    std::memory_order_relaxed)) {
+                return adopt(frame);
+            }
+        }
+        return FrameHandle();
+    }
+
+    // Detach the reference without dropping it (see adopt)
+    Frame* release() {
+        Frame* frame = frame_;
+        frame_       = nullptr;
+        return frame;
+    }
+
+    // Drop the reference, recycling the frame if it was the last one
+    void reset() {
+        if (frame_ &&
+            frame_->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            frame_->owner->recycle(frame_);
+        }
+        frame_ = nullptr;
+    }
+
+    explicit operator bool() const { return frame_ != nullptr; }
+
+    const cv::Mat& image() const { return frame_->image; }
+    uint64_t sequence() const { return frame_->sequence; }
+    uint64_t timestamp() const { return frame_->timestamp_ns; }
+    Frame* get() const { return frame_; }
+
+private:
+    Frame* frame_ = nullptr;
+};
+
+} // namespace camera
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "frame.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace camera {
+
+/**
+ * @brief Latest-frame-wins slot between one producer and many consumers
+ * The producer never blocks: publishing replaces the held frame, and a frame
+ * nobody took is counted as overwritten. Consumers always get the newest
+ * frame, and count the frames they skipped by sequence number.
+ */
+class FrameMailbox {
+public:
+    FrameMailbox() = default;
+    ~FrameMailbox() { clear(); }
+
+    FrameMailbox(const FrameMailbox&)            = delete;
+    FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+    // Producer only: replace the held frame
+    void publish(FrameHandle frame);
+
+    // Newest frame, or empty if there is none
+    FrameHandle latest() const;
+
+    // Newest frame if it is newer than lastSequence (which is then updated),
+    // otherwise empty
+    FrameHandle takeNewer(uint64_t& lastSequence);
+
+    bool hasNewer(uint64_t lastSequence) const {
+        return latestSequence_.load(std::memory_order_acquire) > lastSequence;
+    }
+
+    // Drop the held frame
+    void clear();
+
+    // * stats
+    uint64_t published() const { return published_.load(); }
+    // frames replaced before any consumer took them
+    uint64_t overwritten() const { return overwritten_.load(); }
+    // frames consumers jumped over (includes frames the sensor dropped)
+    uint64_t skipped() const { return skipped_.load(); }
+
+private:
+    // the slot owns one reference to its frame
+    std::atomic<Frame*> slot_{nullptr};
+    std::atomic<uint64_t> latestSequence_{0};
+    std::atomic<uint64_t> lastTaken_{0};
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> overwritten_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+} // namespace camera
@@ -44,6 +44,30 @@ public:
         cv::Mat* outputFrame = nullptr
     );
 
+    /**
+     * @brief Detect goalposts using a label image from camera::Segmenter
+     * @param frame Input image frame (only used for the visualization)
+     * @param labels Label image of the frame
+     * @param outputFrame Optional output frame with visualization
+     * @return Pair of GoalpostInfo for blue and yellow goalposts
+     */
+    std::pair<GoalpostInfo, GoalpostInfo> detectGoalposts(
+        const cv::Mat& frame,
+        const cv::Mat& labels,
+        cv::Mat* outputFrame = nullptr
+    );
+
+    /**
+     * @brief Angle of an image point around the center point, 0 straight
+     * up the image (GoalpostInfo::angle, before CamProcessor's offset)
+     */
+    float findGoalAngle(const cv::Point& goalMidpoint);
+
+    /**
+     * @brief Distance of an image point from the center point, in pixels
+     */
+    float findDistanceToGoal(const cv::Point& goalMidpoint);
+
 private:
     // HSV color thresholds
     cv::Scalar BLUE_LOWER;
@@ -62,6 +86,9 @@ private:
     cv::Point m_centerPoint;
 
     // Helper methods
+    std::pair<GoalpostInfo, GoalpostInfo> detectGoalpostsFromMasks(
+        const cv::Mat& frame, cv::Mat& blueMask, cv::Mat& yellowMask,
+        cv::Mat* outputFrame);
     std::vector<cv::Point> detectQuadrilateral(const std::vector<cv::Point>& contour);
     int findTrueBottomEdge(const cv::Mat& frame, const std::vector<cv::Point>& quad, 
                           const cv::Scalar& goalLower, const cv::Scalar& goalUpper);
@@ -70,8 +97,6 @@ private:
     std::vector<cv::Point> getReliableGoalpostContour(const std::vector<std::vector<cv::Point>>& contours);
     std::pair<cv::Point, cv::Point> findClosestPointsToCenter(const std::vector<cv::Point>& quad);
     cv::Point findQuadMidpoint(const std::vector<cv::Point>& quad);
-    float findGoalAngle(const cv::Point& goalMidpoint);
-    float findDistanceToGoal(const cv::Point& goalMidpoint);
     std::vector<cv::Point> orderQuadrilateralPoints(std::vector<cv::Point> pts);
     cv::Point findNearestFieldPoint(const std::vector<cv::Point>& quad, int bottomEdgeY, int frameHeight);
 };
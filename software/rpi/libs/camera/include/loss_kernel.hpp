@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace camera {
+namespace loss_kernel {
+
+/**
+ * @brief Running totals of one pose evaluation
+ * Kept as integers so every kernel gives bit-identical losses
+ */
+struct Accumulator {
+    uint32_t distance = 0;
+    uint32_t count    = 0;
+};
+
+/**
+ * @brief Sum the distance map under a translated, pre-rotated point set
+ * A point (x, y) lands on row = x + row_offset, col = col_offset - y, and is
+ * skipped when outside of [0, rows) x [0, cols)
+ *
+ * @param distance_map CV_8U distance map data (row major)
+ * @param step Bytes per distance map row
+ * @param xs, ys Rotated point coordinates (structure of arrays)
+ * @param count Number of points
+ */
+Accumulator sum_scalar(const uint8_t *distance_map, size_t step, int rows,
+                       int cols, const int16_t *xs, const int16_t *ys,
+                       int count, int32_t row_offset, int32_t col_offset);
+
+/**
+ * @brief Same as sum_scalar, using NEON / AVX2 / SSE2 where available
+ * ^ Falls back to sum_scalar when built without SIMD
+ */
+Accumulator sum_simd(const uint8_t *distance_map, size_t step, int rows,
+                     int cols, const int16_t *xs, const int16_t *ys, int count,
+                     int32_t row_offset, int32_t col_offset);
+
+/**
+ * @brief Name of the instruction set used by sum_simd
+ */
+const char *simd_name();
+
+} // namespace loss_kernel
+} // namespace camera
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "config.hpp"
+#include "goalpost.hpp"
+#include "position.hpp"
+
+namespace camera {
+/**
+ * @brief A pose estimate with its uncertainty, to seed and bound the
+ * localization searches
+ */
+struct PosePrior {
+    bool valid = false;
+    int goals  = 0; // goals the estimate is built from
+
+    // field units, heading in rads (Pos convention)
+    float x = 0.0f, y = 0.0f, heading = 0.0f;
+
+    // position covariance (field units^2) and heading standard deviation
+    float cov_xx = 0.0f, cov_xy = 0.0f, cov_yy = 0.0f;
+    float heading_std = 0.0f;
+
+    Pos pos() const;
+
+    // half widths of the POSE_PRIOR_SIGMAS box
+    int x_window() const;
+    int y_window() const;
+    float heading_window() const;
+};
+
+/**
+ * @brief Heading known from the IMU's fused yaw, so searches only cover
+ * (x, y) in a narrow heading band instead of every heading
+ */
+struct HeadingConstraint {
+    float heading = 0.0f; // rads, Pos convention
+    float std     = HEADING_CONSTRAINT_STD;
+
+    // soft: every pose also pays HEADING_CONSTRAINT_WEIGHT * (error / std)^2
+    // on top of its loss, hard: only the band limits the heading
+    bool soft = true;
+
+    // half width of the searched band, at least a degree
+    float band() const;
+
+    // loss added to a pose with this heading (0 if hard)
+    float penalty(float pose_heading) const;
+};
+
+namespace pose_prior {
+/**
+ * @brief Closed form robot position from the goals and the IMU heading
+ * Each visible goal gives its bearing (a line through the goal) and range
+ * (a distance along it), both linear in the position once the heading is
+ * known, so the position is a 2x2 weighted least squares solve and its
+ * covariance the inverse of the normal matrix. One goal is enough, two pin
+ * the position down far better.
+ *
+ * @param goalposts Blue and yellow goalposts, from
+ * CamProcessor::detect_goalposts
+ * @param heading Robot heading from the IMU (Pos convention)
+ * @param heading_std Standard deviation of heading
+ * @return PosePrior invalid if no goal is visible
+ */
+PosePrior from_goalposts(const std::pair<GoalpostInfo, GoalpostInfo> &goalposts,
+                         float heading,
+                         float heading_std = POSE_PRIOR_HEADING_STD);
+} // namespace pose_prior
+} // namespace camera
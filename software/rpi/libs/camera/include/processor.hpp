@@ -3,8 +3,10 @@
 #include "ball.hpp"
 #include "config.hpp"
 #include "goalpost.hpp"
+#include "pose_prior.hpp"
 #include "position.hpp"
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 namespace camera {
 class CamProcessor {
@@ -14,6 +16,62 @@ class CamProcessor {
 
     static int _frame_count;
 
+    // * distance map helpers
+    static cv::Mat build_white_mask(const cv::Mat &camera_image);
+    static cv::Mat distance_map_from_mask(const cv::Mat &white_mask);
+
+    // * relocalization helpers
+
+    /**
+     * @brief Sort candidates by loss, then greedily keep the best count that
+     * are not within min_distance / min_heading_distance (degrees) of a
+     * better one
+     */
+    static std::vector<std::pair<Pos, float>>
+    select_candidates(std::vector<std::pair<Pos, float>> &candidates,
+                      int count, int min_distance, int min_heading_distance);
+
+    /**
+     * @brief Grid search a window around each center at one pyramid level,
+     * in parallel, returning the best pose of each window
+     * With a soft heading constraint, losses include its penalty.
+     */
+    static std::vector<std::pair<Pos, float>>
+    search_windows(const cv::Mat &distance_map, int level,
+                   const std::vector<std::pair<Pos, float>> &centers,
+                   int window, int step, int heading_window, int heading_step,
+                   const HeadingConstraint *heading = nullptr);
+
+    /**
+     * @brief relocalize over num_headings coarse headings, heading_step
+     * degrees apart from first_heading (degrees)
+     */
+    static std::vector<std::pair<Pos, float>>
+    relocalize_headings(const cv::Mat &camera_image, int num_candidates,
+                        int time_budget_us, int step, int first_heading,
+                        int num_headings, int heading_step,
+                        const HeadingConstraint *heading);
+
+    /**
+     * @brief find_minima_local_grid_search on an already built distance map
+     */
+    static std::pair<Pos, float>
+    local_grid_search(const cv::Mat &distance_map, const Pos &estimate,
+                      int x_variance, int y_variance, float heading_variance,
+                      int x_step, int y_step, float heading_step,
+                      const HeadingConstraint *heading = nullptr);
+
+    /**
+     * @brief find_minima_regression on an already built distance map, kept
+     * within [x_min, x_max] x [y_min, y_max]
+     */
+    static std::pair<Pos, float>
+    regression_search(const cv::Mat &distance_map, const Pos &initial_guess,
+                      int max_iterations, float initial_step_x,
+                      float initial_step_y, float initial_step_heading,
+                      float step_decay, float convergence_threshold,
+                      int x_min, int x_max, int y_min, int y_max);
+
   public:
     CamProcessor()  = default;
     ~CamProcessor() = default;
@@ -35,9 +93,48 @@ class CamProcessor {
 
     /**
      * @brief Process a frame and perform any necessary operations
+     * Runs every stage one after the other, see VisionPipeline for the
+     * pipelined version
      */
     static void process_frame(const cv::Mat &frame);
 
+    // * Frame stages, each only reads the frame and label image, so different
+    // * stages can run on different threads at the same time
+
+    /**
+     * @brief Goalposts seen in a frame, angles relative to the robot heading
+     * @param labels Label image from Segmenter::classify
+     */
+    static std::pair<GoalpostInfo, GoalpostInfo>
+    detect_goalposts(const cv::Mat &frame, const cv::Mat &labels);
+
+    /**
+     * @brief IR point of the ball closest to the given heading
+     * @param labels Label image from Segmenter::classify
+     * @param heading Ball heading from the IR sensors
+     * @param ball Output, only set when found
+     * @return true if the ball was found
+     */
+    static bool detect_ball(const cv::Mat &labels, float heading,
+                            IRPoint &ball);
+
+    /**
+     * @brief Track the position with a local grid search around an estimate
+     * (TRACKING_* in config.hpp), using the white lines of the label image
+     * @param labels Label image from Segmenter::classify
+     */
+    static std::pair<Pos, float> track_position(const cv::Mat &labels,
+                                                const Pos &estimate);
+
+    /**
+     * @brief track_position with the heading from the IMU: only (x, y) is
+     * searched, in the constraint's band around its heading
+     * ^ With a soft constraint the loss includes the heading penalty
+     */
+    static std::pair<Pos, float> track_position(const cv::Mat &labels,
+                                                const Pos &estimate,
+                                                const HeadingConstraint &heading);
+
     /**
      * @brief Calculate the loss based on the camera image and a guess position
      */
@@ -48,6 +145,65 @@ class CamProcessor {
      */
     static float calculate_loss_chunks(const cv::Mat &camera_image, Pos &guess);
 
+    /**
+     * @brief Build the distance map of a frame, used by calculate_loss_distance
+     * Each pixel holds the distance (in pixels, CV_8U) to the nearest white
+     * pixel, clamped to DISTANCE_MAP_MAX_DIST
+     * ^ Build this ONCE per frame, then reuse it for every guess
+     */
+    static cv::Mat build_distance_map(const cv::Mat &camera_image);
+
+    /**
+     * @brief Distance maps at every field_tables pyramid level, level n being
+     * the frame scaled down by 2^n (a level pixel is white if any pixel under
+     * it is)
+     */
+    static std::vector<cv::Mat>
+    build_distance_pyramid(const cv::Mat &camera_image);
+
+    /**
+     * @brief Same as build_distance_pyramid, from a white mask (for example
+     * Segmenter::mask(labels, CLASS_WHITE))
+     */
+    static std::vector<cv::Mat>
+    build_distance_pyramid_from_mask(const cv::Mat &white_mask);
+
+    /**
+     * @brief Calculate the loss using a distance map from build_distance_map
+     * Same transform as calculate_loss, but each field point costs its
+     * (clamped) distance to the nearest white line instead of a hit / miss,
+     * which gives a smooth loss surface for the searches to descend
+     * 
+     * @return float mean clamped distance, normalized to [0, 1]
+     */
+    static float calculate_loss_distance(const cv::Mat &distance_map,
+                                         Pos &guess);
+
+    /**
+     * @brief Score many guesses against one distance map in a single call
+     * Uses the SIMD loss kernel (NEON on the Pi), which is bit-identical to
+     * the scalar one, so losses match calculate_loss_distance exactly
+     * 
+     * @param distance_map Distance map from build_distance_map
+     * @param guesses Poses to score
+     * @param count Number of poses
+     * @param losses Output, one loss per pose
+     * @param level Pyramid level of distance_map (see build_distance_pyramid)
+     */
+    static void calculate_loss_batch(const cv::Mat &distance_map,
+                                     const Pos *guesses, int count,
+                                     float *losses, int level = 0);
+
+    /**
+     * @brief Same as above, for poses stored as separate arrays (the
+     * ParticleFilter's layout, so it can be a PoseLoss directly)
+     * Positions are rounded to the nearest field unit.
+     */
+    static void calculate_loss_batch(const cv::Mat &distance_map,
+                                     const float *xs, const float *ys,
+                                     const float *headings, int count,
+                                     float *losses, int level = 0);
+
     // * Functions to find the minima
 
     /**
@@ -67,21 +223,51 @@ class CamProcessor {
         int variance_per_generation         = PARTICLE_SEARCH_VAR,
         int heading_varience_per_generation = PARTICLE_SEARCH_VAR_HEAD);
     /**
-     * @brief Find the minima from an initial guess, using smart search
-     * Aims to do grid search efficiently by searching middle first
-     * ^ Works quite well for most getting roughly where the bot is quickly
+     * @brief Global relocalization over the whole field, coarse to fine
+     * Searches every pose at the coarse pyramid level, then refines the best
+     * candidates at the mid and full resolution levels, split across all
+     * cores with the shared ThreadPool
+     * ^ Use this when lost (startup, kidnapped), it does not need a guess
      * 
      * @param camera_image The camera image to process
-     * @param center Center position for the search
-     * @param radius Search radius around the center
-     * @param step Step size for x and y positions
-     * @param heading_step Step size for heading angles
+     * @param num_candidates Candidates carried between levels
+     * @param time_budget_us Levels not started within this budget are skipped
+     * @param step Coarse translation step
+     * @param heading_step Coarse heading step, in degrees
+     * @return std::vector<std::pair<Pos, float>> candidates, best first
+     */
+    static std::vector<std::pair<Pos, float>>
+    relocalize(const cv::Mat &camera_image,
+               int num_candidates = RELOCALIZATION_CANDIDATES,
+               int time_budget_us = RELOCALIZATION_TIME_BUDGET_US,
+               int step           = FULL_SEARCH_STEP,
+               int heading_step   = FULL_SEARCH_HEADING_STEP);
+
+    /**
+     * @brief relocalize with the heading from the IMU, the coarse level only
+     * searches the constraint's band (a few headings instead of 360 /
+     * heading_step)
+     * ^ With a soft constraint the losses include the heading penalty
+     */
+    static std::vector<std::pair<Pos, float>>
+    relocalize(const cv::Mat &camera_image, const HeadingConstraint &heading,
+               int num_candidates = RELOCALIZATION_CANDIDATES,
+               int time_budget_us = RELOCALIZATION_TIME_BUDGET_US,
+               int step           = FULL_SEARCH_STEP,
+               int heading_step   = FULL_SEARCH_HEADING_STEP);
+
+    /**
+     * @brief Find the minima over the whole field, the best relocalize result
+     * 
+     * @param camera_image The camera image to process
+     * @param step Coarse translation step
+     * @param heading_step Coarse heading step, in degrees
      * @return std::pair<Pos, float> 
      */
     static std::pair<Pos, float>
     find_minima_full_search(const cv::Mat &camera_image,
-                            int step         = FULL_SEARCH_HEADING_STEP,
-                            int heading_step = FULL_SEARCH_STEP);
+                            int step         = FULL_SEARCH_STEP,
+                            int heading_step = FULL_SEARCH_HEADING_STEP);
 
     /**
      * @brief Find the minima using gradient descent regression
@@ -113,5 +299,25 @@ class CamProcessor {
                                   int x_variance, int y_variance,
                                   float heading_variance, int x_step,
                                   int y_step, float heading_step);
+
+    // * Searches seeded and bounded by a pose prior (pose_prior.hpp), the
+    // * window is the prior's POSE_PRIOR_SIGMAS box instead of a fixed size
+
+    /**
+     * @brief Grid search over the prior's box
+     */
+    static std::pair<Pos, float>
+    find_minima_local_grid_search(const cv::Mat &camera_image,
+                                  const PosePrior &prior,
+                                  int x_step         = TRACKING_XY_STEP,
+                                  int y_step         = TRACKING_XY_STEP,
+                                  float heading_step = TRACKING_HEADING_STEP);
+
+    /**
+     * @brief Regression from the prior's pose, steps no larger than its
+     * standard deviations and never leaving its box
+     */
+    static std::pair<Pos, float>
+    find_minima_regression(const cv::Mat &camera_image, const PosePrior &prior);
 };
 } // namespace camera
\ No newline at end of file
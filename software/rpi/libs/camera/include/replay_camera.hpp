@@ -0,0 +1,119 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "config.hpp"
+#include "frame.hpp"
+#include "frame_mailbox.hpp"
+
+namespace camera {
+
+enum ReplayPacing {
+    // frames come out at the recorded frame rate, like the real camera (slow
+    // consumers skip frames, timestamps follow the wall clock)
+    REPLAY_RECORDED_RATE = 0,
+    // every frame, one after the other, as soon as the previous one is
+    // processed (timestamps are index * frame period, identical every run)
+    REPLAY_FAST = 1,
+};
+
+/**
+ * @brief Drop-in for Camera that replays a recording instead of capturing
+ * Reads a video (anything cv::VideoCapture opens) or a raw dump (a ".raw"
+ * file of back to back BGR frames at the initialize resolution), so the
+ * processing pipeline can run and be benchmarked without camera hardware.
+ */
+class ReplayCamera : public FrameOwner {
+public:
+    using FrameProcessor = std::function<void(const cv::Mat&)>;
+    using FrameSink = std::function<void(FrameHandle)>;
+
+    /**
+     * @param path Video or raw dump to replay
+     * @param pacing See ReplayPacing
+     * @param loop Start over at the end instead of stopping
+     * @param fps Frame rate of raw dumps (and of videos that do not say)
+     */
+    explicit ReplayCamera(const std::string& path,
+                          ReplayPacing pacing = REPLAY_RECORDED_RATE,
+                          bool loop = false, double fps = 30);
+    ~ReplayCamera();
+
+    // Open the recording, frames are resized to the resolution if needed
+    bool initialize(Resolutions resolution);
+
+    // Start replaying frames with optional processing callback
+    bool startCapture(FrameProcessor processor = nullptr);
+
+    // Start replaying frames, handing each frame's handle to sink
+    bool startStreaming(FrameSink sink);
+
+    // Stop replaying frames
+    void stopCapture();
+
+    // Check if frames are still being replayed (false at the end, unless
+    // looping)
+    bool isRunning() const;
+
+    // Block until the replay ends or is stopped
+    void waitForEnd();
+
+    // Get the latest replayed frame (no copy, the handle pins the buffer)
+    FrameHandle getLatestFrame() const;
+
+    // Frames read from the recording so far
+    uint64_t framesRead() const { return framesRead_.load(); }
+
+    // Frames replaced before anyone took them / skipped by the capture thread
+    uint64_t overwrittenFrames() const { return mailbox_.overwritten(); }
+    uint64_t skippedFrames() const { return mailbox_.skipped(); }
+
+    // Takes a frame back once its last handle is dropped
+    void recycle(Frame* frame) override;
+
+private:
+    // Recording
+    std::string path_;
+    ReplayPacing pacing_;
+    bool loop_;
+    double fps_;
+    bool raw_ = false;
+    cv::VideoCapture video_;
+    FILE* rawFile_ = nullptr;
+    cv::Mat decoded_;
+
+    // Replay state
+    std::atomic<bool> running_{false};
+    std::thread readerThread_;
+    std::thread captureThread_;
+    FrameSink frameSink_;
+    std::atomic<uint64_t> framesRead_{0};
+
+    // Frame management
+    std::vector<std::unique_ptr<Frame>> frames_;
+    std::mutex freeMutex_;
+    std::condition_variable freeCondition_;
+    std::vector<Frame*> freeFrames_;
+
+    FrameMailbox mailbox_;
+    std::mutex frameMutex_; // only guards the condition variable's wait
+    std::condition_variable frameCondition_;
+
+    int width_ = 0;
+    int height_ = 0;
+
+    // Private methods
+    void readerThreadFunc();
+    void captureThreadFunc();
+    bool readFrame(cv::Mat& image);
+    bool rewind();
+    Frame* takeFreeFrame();
+};
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+namespace camera {
+
+/**
+ * @brief Colour classes of a label image pixel, as bits since classes can
+ * overlap (a bright IR point can also pass as white)
+ */
+enum ColorClass : uint8_t {
+    CLASS_NONE   = 0,
+    CLASS_FIELD  = 1 << 0,
+    CLASS_WHITE  = 1 << 1,
+    CLASS_BLUE   = 1 << 2,
+    CLASS_YELLOW = 1 << 3,
+    CLASS_IR     = 1 << 4,
+};
+
+/**
+ * @brief Single pass colour classifier, shared by the ball, goalpost and line
+ * pipelines
+ * Each BGR pixel is looked up in a 32x32x32 table of class bits, built once
+ * from the thresholds in config.hpp (evaluated at each bin's centre colour)
+ */
+class Segmenter {
+  public:
+    // bins per channel of the lookup table
+    static constexpr int LUT_BITS = 5;
+    static constexpr int LUT_BINS = 1 << LUT_BITS;
+
+    /**
+     * @brief Classify every pixel of a BGR frame in one pass
+     * @param frame CV_8UC3 BGR frame
+     * @param labels Output CV_8U label image of ColorClass bits
+     */
+    static void classify(const cv::Mat &frame, cv::Mat &labels);
+
+    /**
+     * @brief Binary mask (0 / 255) of the pixels having any of the classes
+     * @param labels Label image from classify
+     * @param classes ColorClass bits to select
+     * @param mask Output CV_8U mask
+     */
+    static void mask(const cv::Mat &labels, uint8_t classes, cv::Mat &mask);
+
+  private:
+    static const uint8_t *lut();
+};
+
+} // namespace camera
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ball.hpp"
+#include "bounded_queue.hpp"
+#include "frame.hpp"
+#include "goalpost.hpp"
+#include "position.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace camera {
+
+/**
+ * @brief Everything the vision stages found in one frame
+ */
+struct VisionResult {
+    uint64_t frame_id     = 0; // consecutive, from VisionPipeline::submit
+    uint64_t sequence     = 0; // camera frame sequence
+    uint64_t timestamp_ns = 0; // sensor timestamp, timer::ns() time
+
+    std::pair<GoalpostInfo, GoalpostInfo> goalposts;
+
+    bool ball_found = false;
+    IRPoint ball    = IRPoint();
+
+    Pos pose        = Pos(0, 0, 0);
+    float pose_loss = 1.0f;
+
+    // submit to publish
+    std::chrono::microseconds latency{0};
+};
+
+/**
+ * @brief Staged, multi-core version of CamProcessor::process_frame
+ * segmentation -> {goalposts, ball, localization} in parallel -> publish
+ * Every stage has its own thread (pinned with the VISION_*_CORE constants)
+ * and a bounded input queue, so consecutive frames overlap: segmentation of
+ * frame n + 1 runs while frame n is still being searched. Queues drop their
+ * oldest frame when full, and results older than the last published one are
+ * dropped, so the world model only ever moves forward.
+ */
+class VisionPipeline {
+  public:
+    using Publisher = std::function<void(const VisionResult &)>;
+
+    /**
+     * @param publisher Called on the publish thread, in frame_id order.
+     * Defaults to publish_to_processor
+     */
+    explicit VisionPipeline(Publisher publisher = publish_to_processor);
+    ~VisionPipeline();
+
+    VisionPipeline(const VisionPipeline &)            = delete;
+    VisionPipeline &operator=(const VisionPipeline &) = delete;
+
+    void start();
+    void stop();
+    bool isRunning() const { return running_; }
+
+    /**
+     * @brief Queue a frame, never blocks (the handle keeps the buffer pinned
+     * until every stage is done with it)
+     * @return false if an older frame was dropped to make room
+     */
+    bool submit(FrameHandle frame);
+
+    // * stats
+    uint64_t submitted() const { return nextFrameId_.load() - 1; }
+    uint64_t published() const { return published_.load(); }
+    uint64_t dropped() const { return dropped_.load(); }
+
+    /**
+     * @brief Default publisher, updates the CamProcessor world model
+     * (goalpost_info, ball_position, current_pos)
+     */
+    static void publish_to_processor(const VisionResult &result);
+
+  private:
+    struct Job;
+    using JobPtr = std::shared_ptr<Job>;
+
+    // * stage loops
+    void segmentationLoop();
+    void goalpostLoop();
+    void ballLoop();
+    void localizationLoop();
+    void publishLoop();
+
+    // called by each parallel stage, the last one hands the job to publish
+    void stageDone(const JobPtr &job);
+    void push(BoundedQueue<JobPtr> &queue, JobPtr job);
+
+    Publisher publisher_;
+
+    std::atomic<bool> running_{false};
+    std::vector<std::thread> threads_;
+
+    BoundedQueue<JobPtr> segmentationQueue_;
+    BoundedQueue<JobPtr> goalpostQueue_;
+    BoundedQueue<JobPtr> ballQueue_;
+    BoundedQueue<JobPtr> localizationQueue_;
+    BoundedQueue<JobPtr> publishQueue_;
+
+    // pose the localization stage searches around, updated on publish
+    std::mutex poseMutex_;
+    Pos pose_;
+
+    std::atomic<uint64_t> nextFrameId_{1};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace camera
@@ -0,0 +1,208 @@
+#include "loss_kernel.hpp"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace camera {
+namespace loss_kernel {
+
+Accumulator sum_scalar(const uint8_t *distance_map, size_t step, int rows,
+                       int cols, const int16_t *xs, const int16_t *ys,
+                       int count, int32_t row_offset, int32_t col_offset) {
+    Accumulator acc;
+    for (int i = 0; i < count; i++) {
+        int32_t row = xs[i] + row_offset;
+        int32_t col = col_offset - ys[i];
+
+        // unsigned compare also rejects negatives
+        if ((uint32_t)row >= (uint32_t)rows ||
+            (uint32_t)col >= (uint32_t)cols) {
+            continue;
+        }
+
+        acc.distance += distance_map[row * step + col];
+        acc.count++;
+    }
+    return acc;
+}
+
+#if defined(__ARM_NEON) || defined(__AVX2__) || defined(__SSE2__)
+
+// * each SIMD path computes the in-bounds mask and the byte offsets of a block
+// * of lanes, then gathers with scalar loads (no byte gathers). Out-of-bounds
+// * lanes load offset 0, which is subtracted back out at the end
+
+#if defined(__ARM_NEON)
+constexpr int LANES = 8;
+#elif defined(__AVX2__)
+constexpr int LANES = 16;
+#else
+constexpr int LANES = 8;
+#endif
+
+static inline uint32_t gather(const uint8_t *distance_map,
+                              const int32_t *offsets) {
+    uint32_t distance = 0;
+    for (int lane = 0; lane < LANES; lane++) {
+        distance += distance_map[offsets[lane]];
+    }
+    return distance;
+}
+
+Accumulator sum_simd(const uint8_t *distance_map, size_t step, int rows,
+                     int cols, const int16_t *xs, const int16_t *ys, int count,
+                     int32_t row_offset, int32_t col_offset) {
+    // lanes are int16, far off-image offsets / huge images take the int32
+    // scalar path
+    if (row_offset < INT16_MIN / 2 || row_offset > INT16_MAX / 2 ||
+        col_offset < INT16_MIN / 2 || col_offset > INT16_MAX / 2 ||
+        step > INT16_MAX) {
+        return sum_scalar(distance_map, step, rows, cols, xs, ys, count,
+                          row_offset, col_offset);
+    }
+
+    Accumulator acc;
+    alignas(32) int32_t offsets[LANES];
+    uint32_t lanes = 0;
+
+    int i = 0;
+
+#if defined(__ARM_NEON)
+    const int16x8_t v_row_offset = vdupq_n_s16((int16_t)row_offset);
+    const int16x8_t v_col_offset = vdupq_n_s16((int16_t)col_offset);
+    const uint16x8_t v_rows      = vdupq_n_u16((uint16_t)rows);
+    const uint16x8_t v_cols      = vdupq_n_u16((uint16_t)cols);
+
+    for (; i + LANES <= count; i += LANES) {
+        int16x8_t r = vaddq_s16(vld1q_s16(xs + i), v_row_offset);
+        int16x8_t c = vsubq_s16(v_col_offset, vld1q_s16(ys + i));
+
+        // unsigned compare also rejects negatives
+        uint16x8_t ok = vandq_u16(vcltq_u16(vreinterpretq_u16_s16(r), v_rows),
+                                  vcltq_u16(vreinterpretq_u16_s16(c), v_cols));
+        r             = vandq_s16(r, vreinterpretq_s16_u16(ok));
+        c             = vandq_s16(c, vreinterpretq_s16_u16(ok));
+
+        // row * step + col, widened to 32 bit
+        vst1q_s32(offsets, vmlaq_n_s32(vmovl_s16(vget_low_s16(c)),
+                                       vmovl_s16(vget_low_s16(r)),
+                                       (int32_t)step));
+        vst1q_s32(offsets + 4, vmlaq_n_s32(vmovl_s16(vget_high_s16(c)),
+                                           vmovl_s16(vget_high_s16(r)),
+                                           (int32_t)step));
+        acc.distance += gather(distance_map, offsets);
+
+        uint64x2_t valid = vpaddlq_u32(vpaddlq_u16(vshrq_n_u16(ok, 15)));
+        acc.count += vgetq_lane_u64(valid, 0) + vgetq_lane_u64(valid, 1);
+        lanes += LANES;
+    }
+#elif defined(__AVX2__)
+    const __m256i v_row_offset = _mm256_set1_epi16((int16_t)row_offset);
+    const __m256i v_col_offset = _mm256_set1_epi16((int16_t)col_offset);
+    const __m256i v_rows       = _mm256_set1_epi16((int16_t)rows);
+    const __m256i v_cols       = _mm256_set1_epi16((int16_t)cols);
+    const __m256i v_neg_one    = _mm256_set1_epi16(-1);
+    const __m256i v_step = _mm256_set1_epi32((int32_t)(step | 1u << 16));
+
+    for (; i + LANES <= count; i += LANES) {
+        __m256i r = _mm256_add_epi16(
+            _mm256_loadu_si256((const __m256i *)(xs + i)), v_row_offset);
+        __m256i c = _mm256_sub_epi16(
+            v_col_offset, _mm256_loadu_si256((const __m256i *)(ys + i)));
+
+        // 0 <= v < limit, as (v > -1) && (limit > v)
+        __m256i ok = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpgt_epi16(r, v_neg_one),
+                             _mm256_cmpgt_epi16(v_rows, r)),
+            _mm256_and_si256(_mm256_cmpgt_epi16(c, v_neg_one),
+                             _mm256_cmpgt_epi16(v_cols, c)));
+        r = _mm256_and_si256(r, ok);
+        c = _mm256_and_si256(c, ok);
+
+        // row * step + col, as a 32 bit madd over interleaved (row, col)
+        // (the unpack shuffles lanes, which a sum does not care about)
+        _mm256_store_si256(
+            (__m256i *)offsets,
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(r, c), v_step));
+        _mm256_store_si256(
+            (__m256i *)(offsets + 8),
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(r, c), v_step));
+        acc.distance += gather(distance_map, offsets);
+
+        acc.count += __builtin_popcount(_mm256_movemask_epi8(ok)) / 2;
+        lanes += LANES;
+    }
+#else
+    const __m128i v_row_offset = _mm_set1_epi16((int16_t)row_offset);
+    const __m128i v_col_offset = _mm_set1_epi16((int16_t)col_offset);
+    const __m128i v_rows       = _mm_set1_epi16((int16_t)rows);
+    const __m128i v_cols       = _mm_set1_epi16((int16_t)cols);
+    const __m128i v_neg_one    = _mm_set1_epi16(-1);
+    const __m128i v_step       = _mm_set1_epi32((int32_t)(step | 1u << 16));
+
+    for (; i + LANES <= count; i += LANES) {
+        __m128i r = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(xs + i)),
+                                  v_row_offset);
+        __m128i c = _mm_sub_epi16(v_col_offset,
+                                  _mm_loadu_si128((const __m128i *)(ys + i)));
+
+        // 0 <= v < limit, as (v > -1) && (limit > v)
+        __m128i ok = _mm_and_si128(
+            _mm_and_si128(_mm_cmpgt_epi16(r, v_neg_one),
+                          _mm_cmplt_epi16(r, v_rows)),
+            _mm_and_si128(_mm_cmpgt_epi16(c, v_neg_one),
+                          _mm_cmplt_epi16(c, v_cols)));
+        r = _mm_and_si128(r, ok);
+        c = _mm_and_si128(c, ok);
+
+        // row * step + col, as a 32 bit madd over interleaved (row, col)
+        _mm_store_si128((__m128i *)offsets,
+                        _mm_madd_epi16(_mm_unpacklo_epi16(r, c), v_step));
+        _mm_store_si128((__m128i *)(offsets + 4),
+                        _mm_madd_epi16(_mm_unpackhi_epi16(r, c), v_step));
+        acc.distance += gather(distance_map, offsets);
+
+        acc.count += __builtin_popcount(_mm_movemask_epi8(ok)) / 2;
+        lanes += LANES;
+    }
+#endif
+
+    // * out-of-bounds lanes all loaded offset 0
+    acc.distance -= distance_map[0] * (lanes - acc.count);
+
+    // * tail
+    Accumulator tail = sum_scalar(distance_map, step, rows, cols, xs + i,
+                                  ys + i, count - i, row_offset, col_offset);
+    acc.distance += tail.distance;
+    acc.count += tail.count;
+    return acc;
+}
+
+const char *simd_name() {
+#if defined(__ARM_NEON)
+    return "NEON";
+#elif defined(__AVX2__)
+    return "AVX2";
+#else
+    return "SSE2";
+#endif
+}
+
+#else
+
+Accumulator sum_simd(const uint8_t *distance_map, size_t step, int rows,
+                     int cols, const int16_t *xs, const int16_t *ys, int count,
+                     int32_t row_offset, int32_t col_offset) {
+    return sum_scalar(distance_map, step, rows, cols, xs, ys, count,
+                      row_offset, col_offset);
+}
+
+const char *simd_name() { return "scalar"; }
+
+#endif
+
+} // namespace loss_kernel
+} // namespace camera
@@ -0,0 +1,125 @@
+#include "pose_prior.hpp"
+#include "config.hpp"
+#include "field.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace camera {
+Pos PosePrior::pos() const {
+    float wrapped = std::fmod(heading, 2 * (float)M_PI);
+    if (wrapped < 0) {
+        wrapped += 2 * (float)M_PI;
+    }
+    return Pos((int)lroundf(x), (int)lroundf(y), wrapped);
+}
+
+int PosePrior::x_window() const {
+    return (int)std::ceil(POSE_PRIOR_SIGMAS * std::sqrt(cov_xx));
+}
+
+int PosePrior::y_window() const {
+    return (int)std::ceil(POSE_PRIOR_SIGMAS * std::sqrt(cov_yy));
+}
+
+float PosePrior::heading_window() const {
+    return std::min(POSE_PRIOR_SIGMAS * heading_std, (float)M_PI);
+}
+
+float HeadingConstraint::band() const {
+    return std::min(std::max(HEADING_CONSTRAINT_SIGMAS * std,
+                             (float)M_PI / 180.0f),
+                    (float)M_PI);
+}
+
+float HeadingConstraint::penalty(float pose_heading) const {
+    if (!soft || std <= 0.0f) {
+        return 0.0f;
+    }
+    float error = std::remainder(pose_heading - heading, 2 * (float)M_PI) / std;
+    return HEADING_CONSTRAINT_WEIGHT * error * error;
+}
+
+namespace pose_prior {
+// normal equations of the weighted least squares, normal * p = rhs
+struct Normal {
+    double xx = 0.0, xy = 0.0, yy = 0.0;
+    double rhs_x = 0.0, rhs_y = 0.0;
+
+    // a . p = b, with standard deviation std
+    void add(double a_x, double a_y, double b, double std) {
+        double weight = 1.0 / (std * std);
+        xx += weight * a_x * a_x;
+        xy += weight * a_x * a_y;
+        yy += weight * a_y * a_y;
+        rhs_x += weight * a_x * b;
+        rhs_y += weight * a_y * b;
+    }
+};
+
+PosePrior from_goalposts(const std::pair<GoalpostInfo, GoalpostInfo> &goalposts,
+                         float heading, float heading_std) {
+    const GoalpostInfo *infos[2] = {&goalposts.first, &goalposts.second};
+    const float goal_x[2]        = {GOAL_BLUE_X, GOAL_YELLOW_X};
+
+    PosePrior prior;
+    prior.heading     = heading;
+    prior.heading_std = heading_std;
+
+    Normal normal;
+    for (int i = 0; i < 2; i++) {
+        const GoalpostInfo &info = *infos[i];
+        if (!info.detected) {
+            continue;
+        }
+        prior.goals++;
+
+        // From pose (x, y, heading), a field point p shows up at
+        // v = R(heading) (p + (x, y)) from the image center, row along v.x
+        // and column against v.y (the projection CamProcessor::calculate_loss
+        // matches the lines with). findGoalAngle puts it at angle(v) + pi,
+        // and detect_goalposts adds GOALPOST_ANGLE_OFFSET. So goal + (x, y)
+        // points along offset, range long.
+        float offset =
+            info.angle - GOALPOST_ANGLE_OFFSET - (float)M_PI - heading;
+        float along_x = std::cos(offset);
+        float along_y = std::sin(offset);
+        float range   = info.distance * GOAL_DISTANCE_SCALE;
+
+        // along the offset: (goal + p) . along = range
+        normal.add(along_x, along_y,
+                   range - along_x * goal_x[i] - along_y * GOAL_Y,
+                   GOAL_RANGE_STD * range + GOAL_RANGE_STD_MIN);
+
+        // across it: goal + p is on the line, off by the angular error
+        // (bearing and heading) times the range
+        double angle_std = std::sqrt(GOAL_BEARING_STD * GOAL_BEARING_STD +
+                                     heading_std * heading_std);
+        normal.add(-along_y, along_x,
+                   along_y * goal_x[i] - along_x * GOAL_Y,
+                   std::max(range, GOAL_RANGE_STD_MIN) * angle_std);
+    }
+
+    double det = normal.xx * normal.yy - normal.xy * normal.xy;
+    if (prior.goals == 0 || det <= 1e-12) {
+        return prior;
+    }
+
+    // covariance is the inverse of the normal matrix
+    double inv_xx = normal.yy / det;
+    double inv_xy = -normal.xy / det;
+    double inv_yy = normal.xx / det;
+
+    prior.x      = inv_xx * normal.rhs_x + inv_xy * normal.rhs_y;
+    prior.y      = inv_xy * normal.rhs_x + inv_yy * normal.rhs_y;
+    prior.cov_xx = inv_xx;
+    prior.cov_xy = inv_xy;
+    prior.cov_yy = inv_yy;
+
+    // a goal seen from off the field is a misdetection
+    const float margin = 2 * GOAL_RANGE_STD_MIN;
+    prior.valid = std::fabs(prior.x) <= field::FIELD_X_SIZE / 2 + margin &&
+                  std::fabs(prior.y) <= field::FIELD_Y_SIZE / 2 + margin;
+    return prior;
+}
+} // namespace pose_prior
+} // namespace camera
@@ -3,11 +3,17 @@
 #include "config.hpp"
 #include "debug.hpp"
 #include "field.hpp"
-#include "field_chunked.hpp"
+#include "field_tables.hpp"
 #include "goalpost.hpp"
+#include "loss_kernel.hpp"
 #include "position.hpp"
+#include "segmentation.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <limits>
 #include <opencv2/core/cvdef.h>
 #include <unistd.h>
 #include <utility>
@@ -29,53 +35,34 @@ int CamProcessor::generate_random_number(int mid, int variance, int min,
 float CamProcessor::calculate_loss(const cv::Mat &camera_image, Pos &guess) {
     uint32_t count = 0, non_white = 0;
 
-    // Fixed-point scaling factor (Q16.16 format)
-    constexpr int FP_SHIFT = 16;
-    constexpr int FP_ONE   = 1 << FP_SHIFT;
+    // Field points pre-rotated to the guess heading
+    const field_tables::RotatedPoints &points =
+        field_tables::white_lines(field_tables::heading_to_bin(guess.heading));
 
-    // Convert angles to fixed point representation
-    int32_t sin_theta_fp = static_cast<int32_t>(sin(guess.heading) * FP_ONE);
-    int32_t cos_theta_fp = static_cast<int32_t>(cos(guess.heading) * FP_ONE);
+    // Rotate the translation once, R(p + t) = Rp + Rt
+    int32_t offset_x =
+        ((guess.x * points.cos_fp - guess.y * points.sin_fp) >>
+         field_tables::FP_SHIFT) +
+        IMG_WIDTH / 2;
+    int32_t offset_y =
+        ((guess.x * points.sin_fp + guess.y * points.cos_fp) >>
+         field_tables::FP_SHIFT) +
+        IMG_HEIGHT / 2;
 
-    // Transform & rotate white line coords
-    for (int i = 0; i < field::WHITE_LINES_LENGTH; i++) {
-        int16_t x = field::WHITE_LINES[i][0];
-        int16_t y = field::WHITE_LINES[i][1];
-
-        // Transform to relative coordinates
-        int32_t rel_x = x + guess.x;
-        int32_t rel_y = y + guess.y;
-
-        // Rotate using fixed-point arithmetic
-        int32_t rotated_x_fp =
-            (rel_x * cos_theta_fp - rel_y * sin_theta_fp) >> FP_SHIFT;
-        int32_t rotated_y_fp =
-            (rel_x * sin_theta_fp + rel_y * cos_theta_fp) >> FP_SHIFT;
-
-        // Convert back to integer coordinate space with offset
-        int32_t final_x = rotated_x_fp + IMG_WIDTH / 2;
-        int32_t final_y = rotated_y_fp + IMG_HEIGHT / 2;
+    for (int i = 0; i < points.count; i++) {
+        int32_t row = points.x[i] + offset_x;
+        int32_t col = IMG_HEIGHT - (points.y[i] + offset_y);
 
         // Check if the point is within IMAGE boundaries
-        if (final_x < 0 || final_x >= IMG_WIDTH || final_y < 0 ||
-            final_y >= IMG_HEIGHT) {
+        if (row < 0 || row >= IMG_WIDTH || col < 0 || col >= IMG_HEIGHT) {
             continue;
         }
 
-        // printf("FINAL X: %d, FINAL Y: %d\n", final_x, final_y);
-        const cv::Vec3b *row   = camera_image.ptr<cv::Vec3b>(final_x);
-        const cv::Vec3b &pixel = row[IMG_HEIGHT - final_y];
+        const cv::Vec3b &pixel = camera_image.ptr<cv::Vec3b>(row)[col];
 
         if (!(pixel[0] > COLOR_R_THRES && pixel[1] > COLOR_G_THRES &&
               pixel[2] > COLOR_B_THRES)) {
             non_white++;
-            // debug::log("White pixel at (%d, %d): (%d, %d, %d)",
-            //            IMG_HEIGHT - final_y, final_x, pixel[0], pixel[1],
-            //            pixel[2]);
-        } else {
-            // debug::log("Non-white pixel at (%d, %d): (%d, %d, %d)",
-            //            IMG_HEIGHT - final_y, final_x, pixel[0], pixel[1],
-            //            pixel[2]);
         }
         count++;
     }
@@ -83,7 +70,6 @@ float CamProcessor::calculate_loss(const cv::Mat &camera_image, Pos &guess) {
     if (count == 0) {
         return 1.0f;
     }
-    // printf("Count: %d, Non-white: %d\n", count, non_white);
 
     // Use integer division if possible, or at least avoid double casting
     float loss = static_cast<float>(non_white) / count;
@@ -94,54 +80,35 @@ float CamProcessor::calculate_loss_chunks(const cv::Mat &camera_image,
                                           Pos &guess) {
     uint32_t count = 0, non_white = 0;
 
-    // Fixed-point scaling factor (Q16.16 format)
-    constexpr int FP_SHIFT = 16;
-    constexpr int FP_ONE   = 1 << FP_SHIFT;
-
-    // Convert angles to fixed point representation
-    int32_t sin_theta_fp = static_cast<int32_t>(sin(guess.heading) * FP_ONE);
-    int32_t cos_theta_fp = static_cast<int32_t>(cos(guess.heading) * FP_ONE);
-
-    // Transform & rotate white line coords
-    for (int i = 0; i < field_chunked::WHITE_CHUNK_COUNT; i++) {
-        int16_t x = field_chunked::WHITE_CHUNK_INDICES[i][0];
-        int16_t y = field_chunked::WHITE_CHUNK_INDICES[i][1];
-
-        // Transform to relative coordinates
-        int32_t rel_x = x + guess.x / field_chunked::CHUNK_SIZE;
-        int32_t rel_y = y + guess.y / field_chunked::CHUNK_SIZE;
-
-        // Rotate using fixed-point arithmetic
-        int32_t rotated_x_fp =
-            (rel_x * cos_theta_fp - rel_y * sin_theta_fp) >> FP_SHIFT;
-        int32_t rotated_y_fp =
-            (rel_x * sin_theta_fp + rel_y * cos_theta_fp) >> FP_SHIFT;
-
-        // Convert back to integer coordinate space with offset
-        int32_t final_x =
-            rotated_x_fp + (IMG_WIDTH / 2) / field_chunked::CHUNK_SIZE;
-        int32_t final_y =
-            rotated_y_fp + (IMG_HEIGHT / 2) / field_chunked::CHUNK_SIZE;
+    // Chunk indices pre-rotated to the guess heading
+    const field_tables::RotatedPoints &points =
+        field_tables::white_chunks(field_tables::heading_to_bin(guess.heading));
+
+    // Rotate the translation (in chunks) once
+    int32_t chunk_x = guess.x / field_tables::CHUNK_SIZE;
+    int32_t chunk_y = guess.y / field_tables::CHUNK_SIZE;
+    int32_t offset_x =
+        ((chunk_x * points.cos_fp - chunk_y * points.sin_fp) >>
+         field_tables::FP_SHIFT) +
+        (IMG_WIDTH / 2) / field_tables::CHUNK_SIZE;
+    int32_t offset_y =
+        ((chunk_x * points.sin_fp + chunk_y * points.cos_fp) >>
+         field_tables::FP_SHIFT) +
+        (IMG_HEIGHT / 2) / field_tables::CHUNK_SIZE;
+
+    for (int i = 0; i < points.count; i++) {
+        int32_t final_x = points.x[i] + offset_x;
+        int32_t final_y = points.y[i] + offset_y;
 
         // Check if the point is within IMAGE boundaries
-        if (final_x < 0 || final_x >= IMG_WIDTH / field_chunked::CHUNK_SIZE ||
-            final_y < 0 || final_y >= IMG_HEIGHT / field_chunked::CHUNK_SIZE) {
+        if (final_x < 0 || final_x >= IMG_WIDTH / field_tables::CHUNK_SIZE ||
+            final_y < 0 || final_y >= IMG_HEIGHT / field_tables::CHUNK_SIZE) {
             continue;
         }
 
-        const cv::Vec3b *row   = camera_image.ptr<cv::Vec3b>(final_x);
-        const cv::Vec3b &pixel = row[IMG_HEIGHT - final_y];
-
-        if (!(pixel[0] > COLOR_R_THRES && pixel[1] > COLOR_G_THRES &&
-              pixel[2] > COLOR_B_THRES)) {
+        // the shrunk image is single channel and already column-flipped
+        if (camera_image.ptr<uint8_t>(final_x)[final_y] == 0) {
             non_white++;
-            // debug::log("White pixel at (%d, %d): (%d, %d, %d)",
-            //            IMG_HEIGHT - final_y, final_x, pixel[0], pixel[1],
-            //            pixel[2]);
-        } else {
-            // debug::log("Non-white pixel at (%d, %d): (%d, %d, %d)",
-            //            IMG_HEIGHT - final_y, final_x, pixel[0], pixel[1],
-            //            pixel[2]);
         }
         count++;
     }
@@ -155,18 +122,132 @@ float CamProcessor::calculate_loss_chunks(const cv::Mat &camera_image,
     return loss;
 }
 
+cv::Mat CamProcessor::build_white_mask(const cv::Mat &camera_image) {
+    // channel order matches calculate_loss
+    cv::Mat white_mask;
+    cv::inRange(camera_image,
+                cv::Scalar(COLOR_R_THRES + 1, COLOR_G_THRES + 1,
+                           COLOR_B_THRES + 1),
+                cv::Scalar(255, 255, 255), white_mask);
+    return white_mask;
+}
+
+cv::Mat CamProcessor::distance_map_from_mask(const cv::Mat &white_mask) {
+    // * distance to the nearest white pixel (white pixels must be zero)
+    cv::Mat not_white, distances;
+    cv::bitwise_not(white_mask, not_white);
+    cv::distanceTransform(not_white, distances, cv::DIST_L2, cv::DIST_MASK_3,
+                          CV_32F);
+
+    // * clamp and pack into bytes, so lookups stay cache friendly
+    cv::Mat distance_map;
+    cv::min(distances, DISTANCE_MAP_MAX_DIST, distances);
+    distances.convertTo(distance_map, CV_8U);
+    return distance_map;
+}
+
+cv::Mat CamProcessor::build_distance_map(const cv::Mat &camera_image) {
+    return distance_map_from_mask(build_white_mask(camera_image));
+}
+
+std::vector<cv::Mat>
+CamProcessor::build_distance_pyramid(const cv::Mat &camera_image) {
+    return build_distance_pyramid_from_mask(build_white_mask(camera_image));
+}
+
+std::vector<cv::Mat>
+CamProcessor::build_distance_pyramid_from_mask(const cv::Mat &white_mask) {
+    std::vector<cv::Mat> pyramid(field_tables::PYRAMID_LEVELS);
+    pyramid[0] = distance_map_from_mask(white_mask);
+
+    for (int level = 1; level < field_tables::PYRAMID_LEVELS; level++) {
+        // a level pixel is white if any pixel under it is white
+        cv::Mat shrunk_mask;
+        cv::resize(white_mask, shrunk_mask,
+                   cv::Size(IMG_HEIGHT >> level, IMG_WIDTH >> level), 0, 0,
+                   cv::INTER_AREA);
+        cv::threshold(shrunk_mask, shrunk_mask, 0, 255, cv::THRESH_BINARY);
+        pyramid[level] = distance_map_from_mask(shrunk_mask);
+    }
+
+    return pyramid;
+}
+
+float CamProcessor::calculate_loss_distance(const cv::Mat &distance_map,
+                                            Pos &guess) {
+    float loss;
+    calculate_loss_batch(distance_map, &guess, 1, &loss);
+    return loss;
+}
+
+// loss of one pose, shared by both calculate_loss_batch layouts
+static float pose_loss(const cv::Mat &distance_map, int x, int y,
+                       float heading, int level) {
+    const int rows  = IMG_WIDTH >> level;
+    const int cols  = IMG_HEIGHT >> level;
+    const int shift = field_tables::FP_SHIFT + level;
+
+    // Field points pre-rotated to the guess heading
+    const field_tables::RotatedPoints &points = field_tables::white_lines(
+        field_tables::heading_to_bin(heading), level);
+
+    // Rotate the translation once, R(p + t) = Rp + Rt
+    int32_t offset_x =
+        ((x * points.cos_fp - y * points.sin_fp) >> shift) + rows / 2;
+    int32_t offset_y =
+        ((x * points.sin_fp + y * points.cos_fp) >> shift) + cols / 2;
+
+    // same row / column mapping as calculate_loss
+    loss_kernel::Accumulator acc = loss_kernel::sum_simd(
+        distance_map.ptr<uint8_t>(), distance_map.step, rows, cols, points.x,
+        points.y, points.count, offset_x, cols - offset_y);
+
+    if (acc.count == 0) {
+        return 1.0f;
+    }
+
+    return static_cast<float>(acc.distance) /
+           (static_cast<float>(acc.count) * DISTANCE_MAP_MAX_DIST);
+}
+
+void CamProcessor::calculate_loss_batch(const cv::Mat &distance_map,
+                                        const Pos *guesses, int count,
+                                        float *losses, int level) {
+    for (int i = 0; i < count; i++) {
+        losses[i] = pose_loss(distance_map, guesses[i].x, guesses[i].y,
+                              guesses[i].heading, level);
+    }
+}
+
+void CamProcessor::calculate_loss_batch(const cv::Mat &distance_map,
+                                        const float *xs, const float *ys,
+                                        const float *headings, int count,
+                                        float *losses, int level) {
+    for (int i = 0; i < count; i++) {
+        losses[i] = pose_loss(distance_map, (int)lroundf(xs[i]),
+                              (int)lroundf(ys[i]), headings[i], level);
+    }
+}
+
 std::pair<Pos, float> CamProcessor::find_minima_particle_search(
     const cv::Mat &camera_image, Pos &initial_guess, int num_particles,
     int num_generations, int variance_per_generation,
     int heading_varience_per_generation) {
+    cv::Mat distance_map = build_distance_map(camera_image);
+
     Pos best_guess  = initial_guess;
-    float best_loss = calculate_loss(camera_image, best_guess);
+    float best_loss = calculate_loss_distance(distance_map, best_guess);
+
+    std::vector<Pos> guesses;
+    std::vector<float> losses(num_particles);
+    guesses.reserve(num_particles);
 
     for (int i = 0; i < num_generations; i++) {
         Pos current_best_guess  = best_guess;
         float current_best_loss = best_loss;
 
         // disperse points x times
+        guesses.clear();
         for (int j = 0; j < num_particles; j++) {
             Pos new_guess = best_guess;
 
@@ -183,11 +264,16 @@ std::pair<Pos, float> CamProcessor::find_minima_particle_search(
                     heading_varience_per_generation, 0, 360) *
                 (float)M_PI / 180.0f;
 
-            // calculate loss
-            float new_loss = calculate_loss(camera_image, new_guess);
-            if (new_loss < current_best_loss) {
-                current_best_guess = new_guess;
-                current_best_loss  = new_loss;
+            guesses.push_back(new_guess);
+        }
+
+        // calculate losses
+        calculate_loss_batch(distance_map, guesses.data(), guesses.size(),
+                             losses.data());
+        for (int j = 0; j < num_particles; j++) {
+            if (losses[j] < current_best_loss) {
+                current_best_guess = guesses[j];
+                current_best_loss  = losses[j];
             }
         }
 
@@ -201,86 +287,231 @@ std::pair<Pos, float> CamProcessor::find_minima_particle_search(
     return std::make_pair(best_guess, best_loss);
 }
 
-std::pair<Pos, float>
-CamProcessor::find_minima_full_search(const cv::Mat &camera_image, int step,
-                                      int heading_step) {
-    // * shrink the image to speed up the search
-    cv::Mat shrunk_img =
-        cv::Mat(IMG_WIDTH / field_chunked::CHUNK_SIZE,
-                IMG_HEIGHT / field_chunked::CHUNK_SIZE, CV_8UC1);
-
-    int whiteness[IMG_WIDTH / field_chunked::CHUNK_SIZE]
-                 [IMG_HEIGHT / field_chunked::CHUNK_SIZE] = {0};
-    for (int i = 0; i < IMG_WIDTH / field_chunked::CHUNK_SIZE; i++) {
-        for (int j = 0; j < IMG_HEIGHT / field_chunked::CHUNK_SIZE; j++) {
-            for (int k = 0; k < field_chunked::CHUNK_SIZE; k++) {
-                for (int l = 0; l < field_chunked::CHUNK_SIZE; l++) {
-                    int corrected_x = i * field_chunked::CHUNK_SIZE + k;
-                    int corrected_y =
-                        IMG_HEIGHT - (j * field_chunked::CHUNK_SIZE + l);
-
-                    if (corrected_x < 0 || corrected_x >= IMG_WIDTH ||
-                        corrected_y < 0 || corrected_y >= IMG_HEIGHT) {
+std::vector<std::pair<Pos, float>>
+CamProcessor::select_candidates(std::vector<std::pair<Pos, float>> &candidates,
+                                int count, int min_distance,
+                                int min_heading_distance) {
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<Pos, float> &a,
+                 const std::pair<Pos, float> &b) {
+                  return a.second < b.second;
+              });
+
+    // greedy non-maximum suppression, so the candidates do not all collapse
+    // onto one basin (the field is symmetric, there are always at least two)
+    std::vector<std::pair<Pos, float>> selected;
+    for (const auto &candidate : candidates) {
+        if ((int)selected.size() >= count) {
+            break;
+        }
+
+        bool suppressed = false;
+        for (const auto &kept : selected) {
+            int heading_distance =
+                std::abs(field_tables::heading_to_bin(candidate.first.heading) -
+                         field_tables::heading_to_bin(kept.first.heading));
+            heading_distance =
+                std::min(heading_distance,
+                         field_tables::HEADING_BINS - heading_distance);
+
+            if (std::abs(candidate.first.x - kept.first.x) < min_distance &&
+                std::abs(candidate.first.y - kept.first.y) < min_distance &&
+                heading_distance < min_heading_distance) {
+                suppressed = true;
+                break;
+            }
+        }
+
+        if (!suppressed) {
+            selected.push_back(candidate);
+        }
+    }
+    return selected;
+}
+
+std::vector<std::pair<Pos, float>> CamProcessor::search_windows(
+    const cv::Mat &distance_map, int level,
+    const std::vector<std::pair<Pos, float>> &centers, int window, int step,
+    int heading_window, int heading_step, const HeadingConstraint *heading) {
+    std::vector<std::pair<Pos, float>> results(centers);
+
+    // one chunk per center
+    ThreadPool::shared().parallel_for(centers.size(), [&](int chunk) {
+        const Pos &center = centers[chunk].first;
+        int center_heading =
+            (int)lroundf(center.heading * 180.0f / (float)M_PI);
+
+        std::vector<Pos> guesses;
+        for (int dh = -heading_window; dh <= heading_window;
+             dh += heading_step) {
+            int heading = ((center_heading + dh) % 360 + 360) % 360;
+            for (int x = center.x - window; x <= center.x + window; x += step) {
+                if (x < -field::FIELD_X_SIZE / 2 || x > field::FIELD_X_SIZE / 2)
+                    continue;
+                for (int y = center.y - window; y <= center.y + window;
+                     y += step) {
+                    if (y < -field::FIELD_Y_SIZE / 2 ||
+                        y > field::FIELD_Y_SIZE / 2)
                         continue;
-                    }
-
-                    const cv::Vec3b *row =
-                        camera_image.ptr<cv::Vec3b>(corrected_x);
-                    const cv::Vec3b &pixel = row[corrected_y];
-                    if (pixel[0] > COLOR_R_THRES && pixel[1] > COLOR_G_THRES &&
-                        pixel[2] > COLOR_B_THRES) {
-                        whiteness[i][j]++;
-                    }
+                    guesses.push_back({x, y, heading * (float)M_PI / 180.0f});
                 }
             }
         }
-    }
 
-    // Create a new image with the whiteness values
-    for (int i = 0; i < IMG_WIDTH / field_chunked::CHUNK_SIZE; i++) {
-        for (int j = 0; j < IMG_HEIGHT / field_chunked::CHUNK_SIZE; j++) {
-            // white if above threshold
-            if (whiteness[i][j] > FULL_SEARCH_WHITE_COUNT_THRESHOLD) {
-                shrunk_img.at<uint8_t>(i, j) = 255;
-            } else {
-                shrunk_img.at<uint8_t>(i, j) = 0;
+        std::vector<float> losses(guesses.size());
+        calculate_loss_batch(distance_map, guesses.data(), guesses.size(),
+                             losses.data(), level);
+
+        // losses of the previous level do not compare to this one
+        results[chunk].second = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < guesses.size(); i++) {
+            float loss =
+                losses[i] + (heading ? heading->penalty(guesses[i].heading) : 0);
+            if (loss < results[chunk].second) {
+                results[chunk] = {guesses[i], loss};
             }
         }
-    }
+    });
 
-    Pos best_guess  = {0, 0, 0};
-    float best_loss = 1;
+    return results;
+}
 
-    // Search boundaries
-    int x_min = 0;
-    int x_max = field::FIELD_Y_SIZE / 2;
-    int y_min = 0; // TODO: CHANGE
-    int y_max = field::FIELD_Y_SIZE / 2;
+std::vector<std::pair<Pos, float>>
+CamProcessor::relocalize(const cv::Mat &camera_image, int num_candidates,
+                         int time_budget_us, int step, int heading_step) {
+    return relocalize_headings(camera_image, num_candidates, time_budget_us,
+                               step, 0, 360 / heading_step, heading_step,
+                               nullptr);
+}
 
-    for (int x = x_min; x <= x_max; x += step) {
-        for (int y = y_min; y <= y_max; y += step) {
-            for (int heading = 0; heading < 360; heading += heading_step) {
-                Pos guess  = {x, y, heading * (float)M_PI / 180.0f};
-                float loss = calculate_loss_chunks(shrunk_img, guess);
+std::vector<std::pair<Pos, float>>
+CamProcessor::relocalize(const cv::Mat &camera_image,
+                         const HeadingConstraint &heading, int num_candidates,
+                         int time_budget_us, int step, int heading_step) {
+    // the band at up to heading_step, at least 2 steps either side
+    int band = (int)std::ceil(heading.band() * 180.0f / (float)M_PI);
+    int band_step  = std::max(1, std::min(heading_step, band / 2));
+    int half_steps = band / band_step;
+    int center     = (int)lroundf(heading.heading * 180.0f / (float)M_PI);
+
+    return relocalize_headings(camera_image, num_candidates, time_budget_us,
+                               step, center - half_steps * band_step,
+                               2 * half_steps + 1, band_step, &heading);
+}
 
-                if (loss < best_loss) {
-                    best_guess = guess;
-                    best_loss  = loss;
-                }
+std::vector<std::pair<Pos, float>> CamProcessor::relocalize_headings(
+    const cv::Mat &camera_image, int num_candidates, int time_budget_us,
+    int step, int first_heading, int num_headings, int heading_step,
+    const HeadingConstraint *heading) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(time_budget_us);
+    std::vector<cv::Mat> pyramid = build_distance_pyramid(camera_image);
+
+    // * coarse: the whole field at every searched heading, one chunk each
+    const cv::Mat &coarse_map = pyramid[RELOCALIZATION_COARSE_LEVEL];
+
+    std::vector<std::vector<std::pair<Pos, float>>> per_heading(num_headings);
+    ThreadPool::shared().parallel_for(num_headings, [&](int chunk) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return;
+        }
+
+        int degrees = ((first_heading + chunk * heading_step) % 360 + 360) % 360;
+        float chunk_heading = degrees * (float)M_PI / 180.0f;
+        float penalty = heading ? heading->penalty(chunk_heading) : 0.0f;
+
+        std::vector<Pos> guesses;
+        for (int x = -field::FIELD_X_SIZE / 2; x <= field::FIELD_X_SIZE / 2;
+             x += step) {
+            for (int y = -field::FIELD_Y_SIZE / 2;
+                 y <= field::FIELD_Y_SIZE / 2; y += step) {
+                guesses.push_back({x, y, chunk_heading});
             }
         }
+
+        std::vector<float> losses(guesses.size());
+        calculate_loss_batch(coarse_map, guesses.data(), guesses.size(),
+                             losses.data(), RELOCALIZATION_COARSE_LEVEL);
+
+        for (size_t i = 0; i < guesses.size(); i++) {
+            per_heading[chunk].push_back({guesses[i], losses[i] + penalty});
+        }
+
+        // only the best few of each heading can make the final cut
+        auto keep = per_heading[chunk].begin() +
+                    std::min<size_t>(num_candidates, guesses.size());
+        std::partial_sort(per_heading[chunk].begin(), keep,
+                          per_heading[chunk].end(),
+                          [](const std::pair<Pos, float> &a,
+                             const std::pair<Pos, float> &b) {
+                              return a.second < b.second;
+                          });
+        per_heading[chunk].erase(keep, per_heading[chunk].end());
+    });
+
+    std::vector<std::pair<Pos, float>> candidates;
+    for (const auto &heading_candidates : per_heading) {
+        candidates.insert(candidates.end(), heading_candidates.begin(),
+                          heading_candidates.end());
+    }
+    candidates = select_candidates(candidates, num_candidates, 2 * step,
+                                   2 * heading_step);
+
+    // * refine the survivors at each finer level, around the previous cell
+    int prev_step = step, prev_heading_step = heading_step;
+    for (int level : {RELOCALIZATION_MID_LEVEL, 0}) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            debug::warn("Relocalization over budget, stopped above level %d",
+                        level);
+            break;
+        }
+
+        int level_step = 1 << level;
+        candidates     = search_windows(pyramid[level], level, candidates,
+                                        (prev_step + 1) / 2, level_step,
+                                        (prev_heading_step + 1) / 2, 1,
+                                        heading);
+        candidates     = select_candidates(candidates, num_candidates,
+                                           level_step, 1);
+
+        prev_step         = level_step;
+        prev_heading_step = 1;
     }
 
-    return std::make_pair(best_guess, best_loss);
+    return candidates;
+}
+
+std::pair<Pos, float>
+CamProcessor::find_minima_full_search(const cv::Mat &camera_image, int step,
+                                      int heading_step) {
+    std::vector<std::pair<Pos, float>> candidates =
+        relocalize(camera_image, RELOCALIZATION_CANDIDATES,
+                   RELOCALIZATION_TIME_BUDGET_US, step, heading_step);
+    if (candidates.empty()) {
+        return std::make_pair(Pos(0, 0, 0), 1.0f);
+    }
+    return candidates.front();
 }
 
 std::pair<Pos, float> CamProcessor::find_minima_regression(
     const cv::Mat &camera_image, Pos &initial_guess, int max_iterations,
     float initial_step_x, float initial_step_y, float initial_step_heading,
     float step_decay, float convergence_threshold) {
+    return regression_search(build_distance_map(camera_image), initial_guess,
+                             max_iterations, initial_step_x, initial_step_y,
+                             initial_step_heading, step_decay,
+                             convergence_threshold, -field::FIELD_X_SIZE / 2,
+                             field::FIELD_X_SIZE / 2, -field::FIELD_Y_SIZE / 2,
+                             field::FIELD_Y_SIZE / 2);
+}
 
+std::pair<Pos, float> CamProcessor::regression_search(
+    const cv::Mat &distance_map, const Pos &initial_guess, int max_iterations,
+    float initial_step_x, float initial_step_y, float initial_step_heading,
+    float step_decay, float convergence_threshold, int x_min, int x_max,
+    int y_min, int y_max) {
     Pos current_pos    = initial_guess;
-    float current_loss = calculate_loss(camera_image, current_pos);
+    float current_loss = calculate_loss_distance(distance_map, current_pos);
 
     float step_x       = initial_step_x;
     float step_y       = initial_step_y;
@@ -316,7 +547,11 @@ std::pair<Pos, float> CamProcessor::find_minima_regression(
             {0, 0, -step_heading, 0, current_pos} // -heading
         };
 
-        // Try each movement and calculate loss
+        // Try each movement and calculate loss (in one batch)
+        Pos test_positions[num_directions] = {current_pos, current_pos,
+                                              current_pos, current_pos,
+                                              current_pos, current_pos};
+        float test_losses[num_directions];
         for (int i = 0; i < num_directions; i++) {
             Pos test_pos = current_pos;
             test_pos.x += movements[i].dx;
@@ -329,14 +564,18 @@ std::pair<Pos, float> CamProcessor::find_minima_regression(
             while (test_pos.heading >= 2 * M_PI)
                 test_pos.heading -= 2 * M_PI;
 
-            // Keep position within field bounds
-            test_pos.x = std::max(std::min(test_pos.x, field::FIELD_X_SIZE / 2),
-                                  -field::FIELD_X_SIZE / 2);
-            test_pos.y = std::max(std::min(test_pos.y, field::FIELD_Y_SIZE / 2),
-                                  -field::FIELD_Y_SIZE / 2);
+            // Keep position within bounds
+            test_pos.x = std::max(std::min(test_pos.x, x_max), x_min);
+            test_pos.y = std::max(std::min(test_pos.y, y_max), y_min);
+
+            test_positions[i] = test_pos;
+        }
 
-            movements[i].loss = calculate_loss(camera_image, test_pos);
-            movements[i].pos  = test_pos;
+        calculate_loss_batch(distance_map, test_positions, num_directions,
+                             test_losses);
+        for (int i = 0; i < num_directions; i++) {
+            movements[i].loss = test_losses[i];
+            movements[i].pos  = test_positions[i];
         }
 
         // Find the movement with the lowest loss
@@ -369,9 +608,50 @@ std::pair<Pos, float> CamProcessor::find_minima_regression(
 std::pair<Pos, float> CamProcessor::find_minima_local_grid_search(
     const cv::Mat &camera_image, Pos &estimate, int x_variance, int y_variance,
     float heading_variance, int x_step, int y_step, float heading_step) {
+    return local_grid_search(build_distance_map(camera_image), estimate,
+                             x_variance, y_variance, heading_variance, x_step,
+                             y_step, heading_step);
+}
+
+std::pair<Pos, float>
+CamProcessor::find_minima_local_grid_search(const cv::Mat &camera_image,
+                                            const PosePrior &prior, int x_step,
+                                            int y_step, float heading_step) {
+    return local_grid_search(
+        build_distance_map(camera_image), prior.pos(),
+        std::max(prior.x_window(), x_step), std::max(prior.y_window(), y_step),
+        prior.heading_window(), x_step, y_step, heading_step);
+}
+
+std::pair<Pos, float>
+CamProcessor::find_minima_regression(const cv::Mat &camera_image,
+                                     const PosePrior &prior) {
+    Pos seed = prior.pos();
+    int x_window = std::max(prior.x_window(), 1);
+    int y_window = std::max(prior.y_window(), 1);
+
+    // positions are whole units, smaller steps would never move
+    float step_x = std::min(REGRESSION_INITIAL_STEP_X, std::sqrt(prior.cov_xx));
+    float step_y = std::min(REGRESSION_INITIAL_STEP_Y, std::sqrt(prior.cov_yy));
+
+    return regression_search(
+        build_distance_map(camera_image), seed, REGRESSION_MAX_ITERATIONS,
+        std::max(step_x, 1.0f), std::max(step_y, 1.0f),
+        std::min(REGRESSION_INITIAL_STEP_HEADING, prior.heading_std),
+        REGRESSION_STEP_DECAY, REGRESSION_CONVERGENCE_THRESHOLD,
+        std::max(seed.x - x_window, -field::FIELD_X_SIZE / 2),
+        std::min(seed.x + x_window, field::FIELD_X_SIZE / 2),
+        std::max(seed.y - y_window, -field::FIELD_Y_SIZE / 2),
+        std::min(seed.y + y_window, field::FIELD_Y_SIZE / 2));
+}
 
+std::pair<Pos, float> CamProcessor::local_grid_search(
+    const cv::Mat &distance_map, const Pos &estimate, int x_variance,
+    int y_variance, float heading_variance, int x_step, int y_step,
+    float heading_step, const HeadingConstraint *heading) {
     Pos best_guess  = estimate;
-    float best_loss = calculate_loss(camera_image, best_guess);
+    float best_loss = calculate_loss_distance(distance_map, best_guess) +
+                      (heading ? heading->penalty(best_guess.heading) : 0);
 
     // Calculate search boundaries
     int x_min   = estimate.x - x_variance;
@@ -397,27 +677,35 @@ std::pair<Pos, float> CamProcessor::find_minima_local_grid_search(
     while (h_max >= 2 * M_PI)
         h_max -= 2 * M_PI;
 
-    // Grid search
+    // Grid search, one batch per x column
+    std::vector<Pos> guesses;
+    std::vector<float> losses;
     for (int x = x_min; x <= x_max; x += x_step) {
+        guesses.clear();
         for (int y = y_min; y <= y_max; y += y_step) {
             // Handle wrap-around case for heading
             float h = h_min;
             while ((h_min < h_max && h <= h_max) ||
                    (h_min > h_max && (h <= h_max || h >= h_min))) {
-
-                Pos guess  = {x, y, h};
-                float loss = calculate_loss(camera_image, guess);
-
-                if (loss < best_loss) {
-                    best_guess = guess;
-                    best_loss  = loss;
-                }
+                guesses.push_back({x, y, h});
 
                 h += heading_step;
                 if (h >= 2 * M_PI)
                     h -= 2 * M_PI;
             }
         }
+
+        losses.resize(guesses.size());
+        calculate_loss_batch(distance_map, guesses.data(), guesses.size(),
+                             losses.data());
+        for (size_t i = 0; i < guesses.size(); i++) {
+            float loss =
+                losses[i] + (heading ? heading->penalty(guesses[i].heading) : 0);
+            if (loss < best_loss) {
+                best_guess = guesses[i];
+                best_loss  = loss;
+            }
+        }
     }
 
     return std::make_pair(best_guess, best_loss);
@@ -435,27 +723,72 @@ BallDetector CamProcessor::ball_detector = BallDetector();
 IRPoint CamProcessor::ball_position      = IRPoint();
 float CamProcessor::ball_heading         = 0.0f;
 
-void CamProcessor ::process_frame(const cv::Mat &frame) {
-    goalpost_info = goalpost_detector.detectGoalposts(frame);
-    goalpost_info.first.angle += M_PI / 2;
-    goalpost_info.second.angle += M_PI / 2;
+std::pair<GoalpostInfo, GoalpostInfo>
+CamProcessor::detect_goalposts(const cv::Mat &frame, const cv::Mat &labels) {
+    std::pair<GoalpostInfo, GoalpostInfo> info =
+        goalpost_detector.detectGoalposts(frame, labels);
+    info.first.angle += GOALPOST_ANGLE_OFFSET;
+    info.second.angle += GOALPOST_ANGLE_OFFSET;
+    return info;
+}
 
+bool CamProcessor::detect_ball(const cv::Mat &labels, float heading,
+                               IRPoint &ball) {
     // Detect IR points
     cv::Mat irMask;
     std::vector<IRPoint> currentFramePoints =
-        ball_detector.detectIRPoints(frame, irMask);
+        ball_detector.detectIRPointsFromLabels(labels, irMask);
 
     debug::info("Points Count: %d, Heading (IR): %f", currentFramePoints.size(),
-                ball_heading);
-
-    if (currentFramePoints.size() > 0) {
-        ball_position = ball_detector.detectIRPointByHeading(
-            currentFramePoints, ball_heading, BALL_DETECTION_HEADING_TOL);
-        debug::info("Position: %d, %d", ball_position.position.x,
-                    ball_position.position.y);
-        debug::info("Heading: %f", ball_heading);
+                heading);
+
+    if (currentFramePoints.empty()) {
+        return false;
     }
 
+    ball = ball_detector.detectIRPointByHeading(currentFramePoints, heading,
+                                                BALL_DETECTION_HEADING_TOL);
+    debug::info("Position: %d, %d", ball.position.x, ball.position.y);
+    debug::info("Heading: %f", heading);
+    return true;
+}
+
+std::pair<Pos, float> CamProcessor::track_position(const cv::Mat &labels,
+                                                   const Pos &estimate) {
+    cv::Mat white_mask;
+    Segmenter::mask(labels, CLASS_WHITE, white_mask);
+
+    return local_grid_search(distance_map_from_mask(white_mask), estimate,
+                             TRACKING_XY_VARIANCE, TRACKING_XY_VARIANCE,
+                             TRACKING_HEADING_VARIANCE, TRACKING_XY_STEP,
+                             TRACKING_XY_STEP, TRACKING_HEADING_STEP);
+}
+
+std::pair<Pos, float>
+CamProcessor::track_position(const cv::Mat &labels, const Pos &estimate,
+                             const HeadingConstraint &heading) {
+    cv::Mat white_mask;
+    Segmenter::mask(labels, CLASS_WHITE, white_mask);
+
+    // centered on the IMU heading, no wider than the free search
+    Pos centered(estimate.x, estimate.y, heading.heading);
+    float window = std::min(heading.band(), TRACKING_HEADING_VARIANCE);
+
+    return local_grid_search(distance_map_from_mask(white_mask), centered,
+                             TRACKING_XY_VARIANCE, TRACKING_XY_VARIANCE,
+                             window, TRACKING_XY_STEP, TRACKING_XY_STEP,
+                             std::min(TRACKING_HEADING_STEP, window),
+                             &heading);
+}
+
+void CamProcessor ::process_frame(const cv::Mat &frame) {
+    // * one colour pass, shared by every detector
+    cv::Mat labels;
+    Segmenter::classify(frame, labels);
+
+    goalpost_info = detect_goalposts(frame, labels);
+    detect_ball(labels, ball_heading, ball_position);
+
     // types::Vec3f32 cur_pos_imu         = IMU::position();
     // types::Vec3f32 cur_orientation_imu = IMU::orientation();
 
@@ -483,8 +816,7 @@ void CamProcessor ::process_frame(const cv::Mat &frame) {
     // last_pos_imu    = cur_pos_imu;
     // last_orient_imu = cur_orientation_imu;
 
-    // auto res = find_minima_local_grid_search(
-    //     frame, current_pos, 12, 12, 14 * M_PI / 180, 3, 3, 2 * M_PI / 180);
+    // auto res = track_position(labels, current_pos);
 
     // current_pos.x       = res.first.x;
     // current_pos.y       = res.first.y;
@@ -0,0 +1,294 @@
+#include "replay_camera.hpp"
+#include "debug.hpp"
+#include "timer.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace camera {
+ReplayCamera::ReplayCamera(const std::string &path, ReplayPacing pacing,
+                           bool loop, double fps)
+    : path_(path), pacing_(pacing), loop_(loop), fps_(fps) {}
+
+ReplayCamera::~ReplayCamera() {
+    stopCapture();
+    mailbox_.clear();
+
+    // ^ any FrameHandle still alive now dangles
+    if (rawFile_) {
+        fclose(rawFile_);
+    }
+}
+
+bool ReplayCamera::initialize(Resolutions resolution) {
+    switch (resolution) {
+        case camera::RES_1232P:
+            width_  = 1640;
+            height_ = 1232;
+            break;
+        case camera::RES_1080P:
+            width_  = 1920;
+            height_ = 1080;
+            break;
+        case camera::RES_480P:
+            width_  = 640;
+            height_ = 480;
+            break;
+        default: std::cerr << "Invalid resolution" << std::endl; return false;
+    }
+
+    // * Open the recording
+    const std::string rawExtension = ".raw";
+    raw_ = path_.size() >= rawExtension.size() &&
+           path_.compare(path_.size() - rawExtension.size(),
+                         rawExtension.size(), rawExtension) == 0;
+
+    if (raw_) {
+        rawFile_ = fopen(path_.c_str(), "rb");
+        if (!rawFile_) {
+            std::cerr << "Failed to open raw dump " << path_ << std::endl;
+            return false;
+        }
+    } else {
+        if (!video_.open(path_)) {
+            std::cerr << "Failed to open video " << path_ << std::endl;
+            return false;
+        }
+
+        double videoFps = video_.get(cv::CAP_PROP_FPS);
+        if (videoFps > 0) {
+            fps_ = videoFps;
+        }
+    }
+
+    if (fps_ <= 0) {
+        std::cerr << "Invalid replay frame rate" << std::endl;
+        return false;
+    }
+
+    // * Allocate frames, filled in place by the reader
+    for (int i = 0; i < CAMERA_BUFFER_COUNT; i++) {
+        std::unique_ptr<Frame> frame = std::make_unique<Frame>();
+        frame->owner = this;
+        frame->image = cv::Mat(height_, width_, CV_8UC3);
+        freeFrames_.push_back(frame.get());
+        frames_.push_back(std::move(frame));
+    }
+
+    debug::info("Replay camera initialized with %s at %dx%d, %.1f fps",
+                path_.c_str(), width_, height_, fps_);
+    return true;
+}
+
+bool ReplayCamera::startCapture(FrameProcessor processor) {
+    if (!processor) {
+        return startStreaming(nullptr);
+    }
+
+    return startStreaming(
+        [processor](FrameHandle frame) { processor(frame.image()); });
+}
+
+bool ReplayCamera::startStreaming(FrameSink sink) {
+    if (running_) {
+        std::cerr << "Replay camera is already running" << std::endl;
+        return false;
+    }
+
+    if (frames_.empty()) {
+        std::cerr << "Replay camera not initialized" << std::endl;
+        return false;
+    }
+
+    // a replay that reached its end still has threads to join
+    stopCapture();
+
+    // every run replays the same frames with the same timestamps
+    if (!rewind()) {
+        std::cerr << "Failed to rewind " << path_ << std::endl;
+        return false;
+    }
+    mailbox_.clear();
+    framesRead_ = 0;
+
+    frameSink_ = std::move(sink);
+    running_   = true;
+
+    readerThread_ = std::thread(&ReplayCamera::readerThreadFunc, this);
+    if (pacing_ == REPLAY_RECORDED_RATE) {
+        captureThread_ = std::thread(&ReplayCamera::captureThreadFunc, this);
+    }
+
+    debug::info("Replay camera started");
+    return true;
+}
+
+void ReplayCamera::stopCapture() {
+    running_ = false;
+
+    // wake the reader (waiting on a free frame) and the capture thread
+    {
+        std::lock_guard<std::mutex> lock(freeMutex_);
+    }
+    freeCondition_.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(frameMutex_);
+    }
+    frameCondition_.notify_all();
+
+    if (readerThread_.joinable()) {
+        readerThread_.join();
+    }
+    if (captureThread_.joinable()) {
+        captureThread_.join();
+    }
+}
+
+bool ReplayCamera::isRunning() const { return running_; }
+
+void ReplayCamera::waitForEnd() {
+    if (readerThread_.joinable()) {
+        readerThread_.join();
+    }
+    if (captureThread_.joinable()) {
+        captureThread_.join();
+    }
+}
+
+FrameHandle ReplayCamera::getLatestFrame() const { return mailbox_.latest(); }
+
+void ReplayCamera::readerThreadFunc() {
+    const uint64_t periodNs = (uint64_t)(1e9 / fps_);
+    const uint64_t startNs  = timer::ns();
+
+    while (running_) {
+        Frame *frame = takeFreeFrame();
+        if (!frame) {
+            break;
+        }
+
+        bool read = readFrame(frame->image);
+        if (!read && loop_) {
+            read = rewind() && readFrame(frame->image);
+        }
+        if (!read) {
+            recycle(frame);
+            break;
+        }
+
+        // sequences start at 1, like Camera
+        uint64_t index  = framesRead_.fetch_add(1);
+        frame->sequence = index + 1;
+
+        if (pacing_ == REPLAY_FAST) {
+            frame->timestamp_ns = index * periodNs;
+
+            // hand it over directly, the next frame is read once it returns
+            FrameHandle handle(frame);
+            mailbox_.publish(handle);
+            if (frameSink_) {
+                frameSink_(std::move(handle));
+            }
+            continue;
+        }
+
+        // * wait until the frame is due, as the sensor would
+        uint64_t dueNs = startNs + index * periodNs;
+        uint64_t nowNs = timer::ns();
+        if (dueNs > nowNs) {
+            std::unique_lock<std::mutex> lock(freeMutex_);
+            freeCondition_.wait_for(lock,
+                                    std::chrono::nanoseconds(dueNs - nowNs),
+                                    [this] { return !running_; });
+        }
+        frame->timestamp_ns = dueNs;
+
+        mailbox_.publish(FrameHandle(frame));
+        {
+            std::lock_guard<std::mutex> lock(frameMutex_);
+        }
+        frameCondition_.notify_one();
+    }
+
+    // end of the recording
+    if (running_) {
+        debug::info("Replay camera reached the end after %llu frames",
+                    (unsigned long long)framesRead_.load());
+    }
+    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(frameMutex_);
+    }
+    frameCondition_.notify_all();
+}
+
+void ReplayCamera::captureThreadFunc() {
+    uint64_t lastSequence = 0;
+
+    while (running_) {
+        // Always jump to the newest frame, older ones are counted as skipped
+        FrameHandle frame = mailbox_.takeNewer(lastSequence);
+        if (!frame) {
+            // Wait for a frame or stop signal
+            std::unique_lock<std::mutex> lock(frameMutex_);
+            frameCondition_.wait_for(lock, std::chrono::milliseconds(100),
+                                     [this, lastSequence] {
+                                         return mailbox_.hasNewer(
+                                                    lastSequence) ||
+                                                !running_;
+                                     });
+            continue;
+        }
+
+        // Process frame if callback provided
+        if (frameSink_) {
+            frameSink_(std::move(frame));
+        }
+    }
+}
+
+bool ReplayCamera::readFrame(cv::Mat &image) {
+    if (raw_) {
+        size_t bytes = image.total() * image.elemSize();
+        return fread(image.data, 1, bytes, rawFile_) == bytes;
+    }
+
+    if (!video_.read(decoded_) || decoded_.empty()) {
+        return false;
+    }
+
+    if (decoded_.cols != width_ || decoded_.rows != height_) {
+        cv::resize(decoded_, image, cv::Size(width_, height_));
+    } else {
+        decoded_.copyTo(image);
+    }
+    return true;
+}
+
+bool ReplayCamera::rewind() {
+    if (raw_) {
+        return fseek(rawFile_, 0, SEEK_SET) == 0;
+    }
+    return video_.set(cv::CAP_PROP_POS_FRAMES, 0);
+}
+
+Frame *ReplayCamera::takeFreeFrame() {
+    std::unique_lock<std::mutex> lock(freeMutex_);
+    freeCondition_.wait(lock,
+                        [this] { return !freeFrames_.empty() || !running_; });
+    if (!running_) {
+        return nullptr;
+    }
+
+    Frame *frame = freeFrames_.back();
+    freeFrames_.pop_back();
+    return frame;
+}
+
+void ReplayCamera::recycle(Frame *frame) {
+    {
+        std::lock_guard<std::mutex> lock(freeMutex_);
+        freeFrames_.push_back(frame);
+    }
+    freeCondition_.notify_one();
+}
+} // namespace camera
@@ -0,0 +1,94 @@
+#include "segmentation.hpp"
+#include "config.hpp"
+#include <array>
+
+namespace camera {
+
+const uint8_t *Segmenter::lut() {
+    static const std::array<uint8_t, LUT_BINS * LUT_BINS * LUT_BINS> table =
+        [] {
+            std::array<uint8_t, LUT_BINS * LUT_BINS * LUT_BINS> table{};
+
+            // * one pixel per bin, at the centre of the bin, indexed b, g, r
+            const int half_bin = (256 / LUT_BINS) / 2;
+            cv::Mat centres(1, (int)table.size(), CV_8UC3);
+            for (int i = 0; i < (int)table.size(); i++) {
+                int b = (i >> (2 * LUT_BITS)) & (LUT_BINS - 1);
+                int g = (i >> LUT_BITS) & (LUT_BINS - 1);
+                int r = i & (LUT_BINS - 1);
+                centres.at<cv::Vec3b>(0, i) = cv::Vec3b(
+                    (b << (8 - LUT_BITS)) + half_bin,
+                    (g << (8 - LUT_BITS)) + half_bin,
+                    (r << (8 - LUT_BITS)) + half_bin);
+            }
+
+            // * run the same thresholds as the detectors, on the centres
+            cv::Mat hsv, gray;
+            cv::cvtColor(centres, hsv, cv::COLOR_BGR2HSV);
+            cv::cvtColor(centres, gray, cv::COLOR_BGR2GRAY);
+
+            cv::Mat field, white, blue, yellow, purple, bright;
+            cv::inRange(hsv, FIELD_COLOR_LOWER, FIELD_COLOR_UPPER, field);
+            cv::inRange(centres,
+                        cv::Scalar(COLOR_R_THRES + 1, COLOR_G_THRES + 1,
+                                   COLOR_B_THRES + 1),
+                        cv::Scalar(255, 255, 255), white);
+            cv::inRange(hsv, GOALPOST_BLUE_LOWER, GOALPOST_BLUE_UPPER, blue);
+            cv::inRange(hsv, GOALPOST_YELLOW_LOWER, GOALPOST_YELLOW_UPPER,
+                        yellow);
+            cv::inRange(hsv, BALL_DETECTION_PURPLE_MASK_LOWER,
+                        BALL_DETECTION_PURPLE_MASK_UPPER, purple);
+            cv::threshold(gray, bright, BALL_DETECTION_MIN_BRIGHTNESS, 255,
+                          cv::THRESH_BINARY);
+
+            for (int i = 0; i < (int)table.size(); i++) {
+                uint8_t label = CLASS_NONE;
+                if (field.at<uint8_t>(0, i))
+                    label |= CLASS_FIELD;
+                if (white.at<uint8_t>(0, i))
+                    label |= CLASS_WHITE;
+                if (blue.at<uint8_t>(0, i))
+                    label |= CLASS_BLUE;
+                if (yellow.at<uint8_t>(0, i))
+                    label |= CLASS_YELLOW;
+                if (purple.at<uint8_t>(0, i) && bright.at<uint8_t>(0, i))
+                    label |= CLASS_IR;
+                table[i] = label;
+            }
+            return table;
+        }();
+
+    return table.data();
+}
+
+void Segmenter::classify(const cv::Mat &frame, cv::Mat &labels) {
+    const uint8_t *table = lut();
+    labels.create(frame.rows, frame.cols, CV_8U);
+
+    constexpr int SHIFT = 8 - LUT_BITS;
+    for (int row = 0; row < frame.rows; row++) {
+        const uint8_t *in = frame.ptr<uint8_t>(row);
+        uint8_t *out      = labels.ptr<uint8_t>(row);
+
+        for (int col = 0; col < frame.cols; col++, in += 3) {
+            out[col] = table[((in[0] >> SHIFT) << (2 * LUT_BITS)) |
+                             ((in[1] >> SHIFT) << LUT_BITS) |
+                             (in[2] >> SHIFT)];
+        }
+    }
+}
+
+void Segmenter::mask(const cv::Mat &labels, uint8_t classes, cv::Mat &mask) {
+    mask.create(labels.rows, labels.cols, CV_8U);
+
+    for (int row = 0; row < labels.rows; row++) {
+        const uint8_t *in = labels.ptr<uint8_t>(row);
+        uint8_t *out      = mask.ptr<uint8_t>(row);
+
+        for (int col = 0; col < labels.cols; col++) {
+            out[col] = (in[col] & classes) ? 255 : 0;
+        }
+    }
+}
+
+} // namespace camera
@@ -0,0 +1,256 @@
+#include "vision_pipeline.hpp"
+#include "config.hpp"
+#include "debug.hpp"
+#include "processor.hpp"
+#include "segmentation.hpp"
+#include "trace.hpp"
+#include <pthread.h>
+#include <sched.h>
+
+namespace camera {
+
+struct VisionPipeline::Job {
+    FrameHandle frame;
+    cv::Mat labels;
+
+    // IR heading and pose estimate at segmentation time
+    float ball_heading = 0.0f;
+    Pos estimate       = Pos(0, 0, 0);
+
+    VisionResult result;
+    std::chrono::steady_clock::time_point submitted;
+
+    // parallel stages still working on this job
+    std::atomic<int> pending{3};
+};
+
+namespace {
+void pin_to_core(std::thread &thread, int core) {
+    if (core < 0) {
+        return;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    int ret = pthread_setaffinity_np(thread.native_handle(), sizeof(cpus),
+                                     &cpus);
+    if (ret) {
+        debug::warn("Failed to pin vision thread to core %d: %d", core, ret);
+    }
+}
+} // namespace
+
+VisionPipeline::VisionPipeline(Publisher publisher)
+    : publisher_(std::move(publisher)), segmentationQueue_(VISION_QUEUE_DEPTH),
+      goalpostQueue_(VISION_QUEUE_DEPTH), ballQueue_(VISION_QUEUE_DEPTH),
+      localizationQueue_(VISION_QUEUE_DEPTH),
+      publishQueue_(VISION_QUEUE_DEPTH), pose_(CamProcessor::current_pos) {}
+
+VisionPipeline::~VisionPipeline() { stop(); }
+
+void VisionPipeline::start() {
+    if (running_) {
+        return;
+    }
+
+    for (auto *queue : {&segmentationQueue_, &goalpostQueue_, &ballQueue_,
+                        &localizationQueue_, &publishQueue_}) {
+        queue->reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(poseMutex_);
+        pose_ = CamProcessor::current_pos;
+    }
+
+    running_ = true;
+
+    std::pair<void (VisionPipeline::*)(), int> stages[] = {
+        {&VisionPipeline::segmentationLoop, VISION_SEGMENTATION_CORE},
+        {&VisionPipeline::goalpostLoop, VISION_GOALPOST_CORE},
+        {&VisionPipeline::ballLoop, VISION_BALL_CORE},
+        {&VisionPipeline::localizationLoop, VISION_LOCALIZATION_CORE},
+        {&VisionPipeline::publishLoop, VISION_PUBLISH_CORE},
+    };
+    for (auto &stage : stages) {
+        threads_.emplace_back(stage.first, this);
+        pin_to_core(threads_.back(), stage.second);
+    }
+
+    debug::info("Vision pipeline started");
+}
+
+void VisionPipeline::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+
+    // closed queues drain, then every loop exits
+    for (auto *queue : {&segmentationQueue_, &goalpostQueue_, &ballQueue_,
+                        &localizationQueue_, &publishQueue_}) {
+        queue->close();
+    }
+    for (auto &thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+
+    debug::info("Vision pipeline stopped (%llu submitted, %llu published, "
+                "%llu dropped)",
+                (unsigned long long)submitted(),
+                (unsigned long long)published(),
+                (unsigned long long)dropped());
+}
+
+bool VisionPipeline::submit(FrameHandle frame) {
+    if (!running_ || !frame) {
+        return false;
+    }
+
+    JobPtr job               = std::make_shared<Job>();
+    job->submitted           = std::chrono::steady_clock::now();
+    job->result.frame_id     = nextFrameId_.fetch_add(1);
+    job->result.sequence     = frame.sequence();
+    job->result.timestamp_ns = frame.timestamp();
+    job->frame               = std::move(frame);
+
+    bool kept = segmentationQueue_.push(std::move(job));
+    if (!kept) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return kept;
+}
+
+void VisionPipeline::push(BoundedQueue<JobPtr> &queue, JobPtr job) {
+    if (!queue.push(std::move(job))) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void VisionPipeline::segmentationLoop() {
+    JobPtr job;
+    while (segmentationQueue_.pop(job)) {
+        {
+            trace::Scope scope("vision_segmentation", job->result.frame_id);
+
+            // * one colour pass, shared by every parallel stage
+            Segmenter::classify(job->frame.image(), job->labels);
+
+            job->ball_heading = CamProcessor::ball_heading;
+            {
+                std::lock_guard<std::mutex> lock(poseMutex_);
+                job->estimate = pose_;
+            }
+        }
+
+        push(goalpostQueue_, job);
+        push(ballQueue_, job);
+        push(localizationQueue_, std::move(job));
+    }
+}
+
+void VisionPipeline::goalpostLoop() {
+    JobPtr job;
+    while (goalpostQueue_.pop(job)) {
+        {
+            trace::Scope scope("vision_goalposts", job->result.frame_id);
+            job->result.goalposts =
+                CamProcessor::detect_goalposts(job->frame.image(), job->labels);
+        }
+        stageDone(job);
+    }
+}
+
+void VisionPipeline::ballLoop() {
+    JobPtr job;
+    while (ballQueue_.pop(job)) {
+        {
+            trace::Scope scope("vision_ball", job->result.frame_id);
+            job->result.ball_found = CamProcessor::detect_ball(
+                job->labels, job->ball_heading, job->result.ball);
+        }
+        stageDone(job);
+    }
+}
+
+void VisionPipeline::localizationLoop() {
+    JobPtr job;
+    while (localizationQueue_.pop(job)) {
+        {
+            trace::Scope scope("vision_localization", job->result.frame_id);
+            std::pair<Pos, float> res =
+                CamProcessor::track_position(job->labels, job->estimate);
+            job->result.pose      = res.first;
+            job->result.pose_loss = res.second;
+        }
+        stageDone(job);
+    }
+}
+
+void VisionPipeline::stageDone(const JobPtr &job) {
+    // acq_rel, so the last stage sees the others' results
+    if (job->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        push(publishQueue_, job);
+    }
+}
+
+void VisionPipeline::publishLoop() {
+    uint64_t lastFrameId = 0;
+
+    JobPtr job;
+    while (publishQueue_.pop(job)) {
+        // stages can finish frames out of order, never publish backwards
+        if (job->result.frame_id <= lastFrameId) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        lastFrameId = job->result.frame_id;
+
+        // the next frames search around this pose
+        {
+            std::lock_guard<std::mutex> lock(poseMutex_);
+            pose_ = job->result.pose;
+        }
+
+        job->result.latency =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - job->submitted);
+
+        {
+            trace::Scope scope("vision_publish", job->result.frame_id);
+            if (publisher_) {
+                publisher_(job->result);
+            }
+        }
+        published_.fetch_add(1, std::memory_order_relaxed);
+
+        // whole frame, from exposure to the world model
+        if (job->result.timestamp_ns) {
+            trace::record("frame_to_publish", job->result.timestamp_ns,
+                          timer::ns(), job->result.frame_id);
+            trace::set_observation(job->result.timestamp_ns);
+        }
+
+        // drop the frame now rather than on the next pop
+        job.reset();
+    }
+}
+
+void VisionPipeline::publish_to_processor(const VisionResult &result) {
+    CamProcessor::goalpost_info = result.goalposts;
+    if (result.ball_found) {
+        CamProcessor::ball_position = result.ball;
+    }
+
+    CamProcessor::current_pos.x       = result.pose.x;
+    CamProcessor::current_pos.y       = result.pose.y;
+    CamProcessor::current_pos.heading = result.pose.heading;
+    debug::info("POSITION: %d, %d, %f (Loss: %f, %lld us)", result.pose.x,
+                result.pose.y, result.pose.heading / M_PI * 180,
+                result.pose_loss, (long long)result.latency.count());
+}
+
+} // namespace camera
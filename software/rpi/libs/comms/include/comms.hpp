@@ -9,6 +9,8 @@
  * Byte 1 & 2: Length (least significant byte first) (excludes length bytes)
  * Byte 3: Identifier (u8 enum)
  * The rest is passed to the specific handler.
+ * With USB_FRAMING_COBS defined, packets (identifier + data) are sent as
+ * COBS frames with a CRC-16 instead, see comms/cobs.hpp.
  */
 
 namespace comms {
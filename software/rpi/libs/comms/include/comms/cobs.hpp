@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+
+#include "types.hpp"
+
+/**
+ * INFO:
+ * COBS framing (used when USB_FRAMING_COBS is defined), in both directions:
+ * frame = COBS(identifier, payload..., CRC-16 low byte, CRC-16 high byte), 0x00
+ * COBS removes every zero byte from the frame, so 0x00 only ever marks the
+ * end of one. A receiver that sees a corrupted, truncated or dropped byte
+ * discards that frame (bad CRC or malformed) and resyncs at the next 0x00.
+ * The CRC is CRC-16/CCITT-FALSE over the identifier and payload.
+ * ^ SYNC WITH THE PICO COPIES (comms/cobs.hpp) ^
+ */
+namespace comms {
+namespace cobs {
+
+static const types::u8 DELIMITER  = 0x00;
+static const types::u16 CRC_INIT  = 0xFFFF;
+static const types::u8 CRC_LENGTH = 2;
+
+// bytes on the wire for a packet (identifier + payload) of packet_len bytes
+constexpr size_t max_frame_size(size_t packet_len) {
+    return packet_len + CRC_LENGTH + (packet_len + CRC_LENGTH) / 254 + 2;
+}
+
+// CRC-16/CCITT-FALSE (poly 0x1021), a nibble at a time
+inline types::u16 crc16(const types::u8 *data, size_t len,
+                        types::u16 crc = CRC_INIT) {
+    static const types::u16 TABLE[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+        0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ TABLE[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ TABLE[(crc >> 12) ^ (data[i] & 0x0f)];
+    }
+    return crc;
+}
+
+/**
+ * @brief Encodes one frame straight into an output buffer, as its pieces
+ * are written, so a packet never has to be assembled first
+ * ^ out must hold max_frame_size(packet length) bytes
+ */
+class Encoder {
+  public:
+    explicit Encoder(types::u8 *out) : _out(out) {}
+
+    void write(const types::u8 *data, size_t len) {
+        _crc = crc16(data, len, _crc);
+        for (size_t i = 0; i < len; i++) {
+            put(data[i]);
+        }
+    }
+
+    void write(types::u8 byte) { write(&byte, 1); }
+
+    // append the CRC and the delimiter, returns the frame's size in bytes
+    size_t finish() {
+        types::u16 crc = _crc;
+        put(crc & 0xff);
+        put(crc >> 8);
+        _out[_code_pos] = _code;
+        _out[_pos++]    = DELIMITER;
+        return _pos;
+    }
+
+  private:
+    void put(types::u8 byte) {
+        if (byte == 0) {
+            close_block();
+            return;
+        }
+        _out[_pos++] = byte;
+        if (++_code == 0xff) {
+            close_block();
+        }
+    }
+
+    // the block's code byte is the distance to the next zero
+    void close_block() {
+        _out[_code_pos] = _code;
+        _code_pos       = _pos++;
+        _code           = 1;
+    }
+
+    types::u8 *_out;
+    size_t _code_pos = 0;
+    size_t _pos      = 1;
+    types::u8 _code  = 1;
+    types::u16 _crc  = CRC_INIT;
+};
+
+/**
+ * @brief Decode a frame in place and check its CRC
+ * @param frame Encoded frame, without its delimiter, overwritten with the
+ * decoded packet (decoding never grows it)
+ * @returns length of the packet (identifier + payload), 0 for a bad frame
+ */
+inline size_t decode(types::u8 *frame, size_t len) {
+    size_t read = 0, write = 0;
+    while (read < len) {
+        types::u8 code = frame[read++];
+        if (code == 0 || read + code - 1 > len) {
+            return 0; // malformed
+        }
+        for (types::u8 i = 1; i < code; i++) {
+            frame[write++] = frame[read++];
+        }
+        if (code != 0xff && read < len) {
+            frame[write++] = 0;
+        }
+    }
+
+    // at least an identifier and the CRC
+    if (write < 1 + CRC_LENGTH) {
+        return 0;
+    }
+    size_t packet_len = write - CRC_LENGTH;
+    types::u16 crc    = frame[packet_len] | (frame[packet_len + 1] << 8);
+    return crc16(frame, packet_len) == crc ? packet_len : 0;
+}
+
+} // namespace cobs
+} // namespace comms
@@ -35,11 +35,12 @@ enum class RecvTopPicoIdentifiers : types::u8 {
 };
 
 enum class SendBottomPicoIdentifiers : types::u8 {
-    MOTOR_DRIVER_CMD = 0,
-    KICKER_CMD       = 1,
-    PING             = 253,
-    BOARD_ID         = 254,
-    DEBUG_TEST_BLINK = 255,
+    MOTOR_DRIVER_CMD     = 0,
+    KICKER_CMD           = 1,
+    MOTOR_DRIVER_CMD_ALL = 2, // all four motors at once
+    PING                 = 253,
+    BOARD_ID             = 254,
+    DEBUG_TEST_BLINK     = 255,
 };
 
 enum class SendMiddlePicoIdentifiers : types::u8 {
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+#include "types.hpp"
+
+namespace usb {
+
+/**
+ * @brief Single thread, power of two byte ring whose storage is mapped twice
+ * back to back, so any span of up to capacity() bytes starting in the ring
+ * is contiguous in memory
+ * Reads go straight into it and packets are parsed (and handed out) in
+ * place, without copying or moving the leftover bytes of a batch.
+ */
+class RxRing {
+  public:
+    /**
+     * @param capacity Rounded up to a power of two multiple of the page size
+     */
+    explicit RxRing(size_t capacity);
+    ~RxRing();
+
+    RxRing(const RxRing &)            = delete;
+    RxRing &operator=(const RxRing &) = delete;
+
+    // false if the mirrored mapping could not be set up
+    bool valid() const { return _base != nullptr; }
+    size_t capacity() const { return _mask + 1; }
+
+    // free space to read into, contiguous
+    types::u8 *write_ptr() { return _base + (_head & _mask); }
+    size_t writable() const { return capacity() - readable(); }
+    void commit(size_t n) { _head += n; }
+
+    // received bytes not consumed yet, contiguous
+    types::u8 *read_ptr() { return _base + (_tail & _mask); }
+    size_t readable() const { return (size_t)(_head - _tail); }
+    void consume(size_t n) { _tail += n; }
+
+  private:
+    types::u8 *_base = nullptr;
+    size_t _mask     = 0;
+    types::u64 _head = 0;
+    types::u64 _tail = 0;
+};
+
+} // namespace usb
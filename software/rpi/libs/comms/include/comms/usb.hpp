@@ -7,9 +7,12 @@
 #include <mutex>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "types.hpp"
+#include "default_usb_config.h"
 #include "identifiers.hpp"
+#include "rx_ring.hpp"
 
 namespace usb {
 
@@ -19,6 +22,17 @@ public:
     static const types::u16 MAX_RX_BUF_SIZE = 1024;
     static const types::u16 MAX_TX_BUF_SIZE = 1024;
 
+    // received bytes buffered per device, fits the longest possible packet
+    static const size_t RX_RING_SIZE = 1 << 17;
+
+    // encoded packets queued per device until the next flush, a queue past
+    // TX_FLUSH_THRESHOLD bytes is flushed straight away
+    static const size_t TX_QUEUE_SIZE      = 4096;
+    static const size_t TX_FLUSH_THRESHOLD = 1024;
+
+    // how long a flush waits for room in a full tty buffer before giving up
+    static const int TX_TIMEOUT_MS = 5;
+
     // Callback type for message handlers
     using MessageCallback = std::function<void(const types::u8*, types::u16)>;
 
@@ -31,10 +45,28 @@ public:
     void addDebugCallbacks();
     static void handle_debug(const types::u8 *data, types::u16 data_len);
     
-    // Send messages to specific boards
+    // Send messages to specific boards, now, after anything already queued
+    // for that board (so messages always reach a board in order)
     bool writeToBottomPico(comms::SendBottomPicoIdentifiers identifier, const types::u8* data, types::u16 data_len);
     bool writeToMiddlePico(comms::SendMiddlePicoIdentifiers identifier, const types::u8* data, types::u16 data_len);
     bool writeToTopPico(comms::SendTopPicoIdentifiers identifier, const types::u8* data, types::u16 data_len);
+
+    // Queue messages for specific boards, sent together by the next flush
+    // (one write per board). Only batch messages with different identifiers:
+    // a Pico copies each packet into one buffer per identifier and the task
+    // it wakes runs after the whole transfer, so queued packets with the same
+    // identifier overwrite each other (four MOTOR_DRIVER_CMD packets would
+    // only apply the last motor)
+    bool queueToBottomPico(comms::SendBottomPicoIdentifiers identifier, const types::u8* data, types::u16 data_len);
+    bool queueToMiddlePico(comms::SendMiddlePicoIdentifiers identifier, const types::u8* data, types::u16 data_len);
+    bool queueToTopPico(comms::SendTopPicoIdentifiers identifier, const types::u8* data, types::u16 data_len);
+
+    // Send everything queued for one board / every board, e.g. at the end
+    // of a control tick
+    // @return false if queued messages were dropped (board missing, or the
+    // write failed or timed out)
+    bool flush(comms::BoardIdentifiers board);
+    bool flush();
     
     // Register message handlers for specific message types
     void registerBottomPicoHandler(comms::RecvBottomPicoIdentifiers identifier, MessageCallback callback);
@@ -43,16 +75,33 @@ public:
                                 MessageCallback callback);
     void registerUnknownPicoHandler(types::u8 identifier, MessageCallback callback);
 
+    // Receive time (timer::ns()) of the packet being handled, only valid
+    // inside a message handler
+    static types::u64 rxTimestamp();
+
+    // Whether the calling thread is the event loop (message handlers run on
+    // it, and must not block)
+    bool onEventLoop() const;
+
+    // Packets dropped as corrupt (bad COBS frame or CRC, or impossible
+    // length), the link resyncs after each
+    types::u64 badFrames() const { return _bad_frames.load(std::memory_order_relaxed); }
+
 private:
     // Struct to store detected Pico devices
     struct PicoDevice {
         std::string port;
         comms::BoardIdentifiers board_id;
         int fd;  // File descriptor for the serial port
-        bool identified;
-        std::thread rx_thread;
-        std::atomic<bool> running;
+        std::atomic<bool> identified;
         std::mutex tx_mutex;
+
+        // encoded packets waiting for a flush, guarded by tx_mutex
+        types::u8 tx_queue[TX_QUEUE_SIZE];
+        size_t tx_len = 0;
+
+        // received bytes, parsed in place, event loop only
+        RxRing rx_ring{RX_RING_SIZE};
     };
 
     // Function to scan for Pico devices on /dev/ttyACM*
@@ -61,27 +110,74 @@ private:
     // Function to identify a Pico board
     void identifyBoard(PicoDevice& device);
     
-    // Thread function to handle receiving data from a Pico
-    void rxThreadFunc(PicoDevice& device);
+    // Create the epoll instance and wakeup eventfd, start the event loop
+    bool startEventLoop();
+
+    // Wake the event loop from another thread (shutdown)
+    void wakeEventLoop();
+
+    // Single thread waiting on every device fd (and the wakeup eventfd),
+    // reading as soon as data arrives and dispatching inline
+    void eventLoop();
+
+    // Read everything available on a device, dispatch complete packets
+    // @return false once the device is gone (hung up or read error)
+    bool receive(PicoDevice& device);
+
+    // Dispatch every complete packet buffered in the device's ring
+    void parsePackets(PicoDevice& device, types::u64 rx_ns);
+
+    // Dispatch one packet (identifier + payload), pointing into the ring
+    void handlePacket(PicoDevice& device, const types::u8* packet, size_t packet_len, types::u64 rx_ns);
+
+    // Stop watching a device (it stays open until destruction)
+    void unwatch(PicoDevice& device);
     
-    // Helper function to write data to a Pico
-    bool writeToPico(PicoDevice& device, const types::u8* identifier_ptr, const types::u8* data, types::u16 data_len);
+    // Encode a packet onto a device's queue, flushing first if it would not
+    // fit, and after if flush_now or the queue is past TX_FLUSH_THRESHOLD
+    bool queueToPico(PicoDevice& device, types::u8 identifier, const types::u8* data, types::u16 data_len, bool flush_now);
+
+    // Write out a device's whole queue, tx_mutex held
+    bool flushQueue(PicoDevice& device);
+
+    // Identified device for a board, nullptr if there is none
+    std::shared_ptr<PicoDevice> findDevice(comms::BoardIdentifiers board);
     
+    // Copy the board's handler table with one entry replaced, and publish it
+    void registerHandler(comms::BoardIdentifiers board, types::u8 identifier, MessageCallback callback);
+
     // Process a received message
-    void processMessage(comms::BoardIdentifiers board, types::u8 identifier, const types::u8* data, types::u16 data_len);
+    void processMessage(comms::BoardIdentifiers board, types::u8 identifier, const types::u8* data, types::u16 data_len, types::u64 rx_ns);
 
     // Store detected Pico devices
     std::map<comms::BoardIdentifiers, std::shared_ptr<PicoDevice>> _devices;
+
+    // every device opened by a scan, identified or not, the event loop
+    // holds raw pointers to them
+    std::vector<std::shared_ptr<PicoDevice>> _opened_devices;
+
+    // event loop
+    int _epoll_fd = -1;
+    int _wake_fd  = -1; // eventfd
+    std::thread _event_thread;
+    std::atomic<bool> _running{false};
+    std::atomic<types::u64> _bad_frames{0};
     
-    // Store message handlers
-    std::map<types::u8, MessageCallback> _bottom_pico_handlers;
-    std::map<types::u8, MessageCallback> _middle_pico_handlers;
-    std::map<types::u8, MessageCallback> _top_pico_handlers;
-    std::map<types::u8, MessageCallback> _unknown_pico_handlers;
-    
+    // Message handlers, one flat table per board indexed by identifier
+    // Tables are immutable once published: registering copies the table and
+    // swaps the pointer (RCU style), so dispatch is one load and never locks.
+    // Replaced tables are only freed on destruction, as the event loop may
+    // still be dispatching from them (registration is rare).
+    struct HandlerTable {
+        MessageCallback handlers[comms::identifier_arr_len];
+    };
+    static const int NUM_BOARDS = static_cast<int>(comms::BoardIdentifiers::UNKNOWN) + 1;
+    std::atomic<const HandlerTable*> _handler_tables[NUM_BOARDS];
+    std::vector<std::unique_ptr<HandlerTable>> _all_handler_tables;
+
     // Mutex for thread safety
     std::mutex _devices_mutex;
-    std::mutex _handlers_mutex;
+    std::mutex _handlers_mutex; // serializes registration only
     
     // Flag to indicate if the communication system is initialized
     bool _initialized;
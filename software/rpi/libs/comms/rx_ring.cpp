@@ -0,0 +1,57 @@
+#include "comms/rx_ring.hpp"
+#include "debug.hpp"
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace usb {
+
+RxRing::RxRing(size_t capacity) {
+    size_t size = sysconf(_SC_PAGESIZE);
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    int fd = memfd_create("usb_rx_ring", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, size) != 0) {
+        debug::error("RxRing: memfd failed: %s", strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return;
+    }
+
+    // reserve twice the size, then map the same pages over both halves
+    void *reserved = mmap(nullptr, 2 * size, PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        debug::error("RxRing: mmap failed: %s", strerror(errno));
+        close(fd);
+        return;
+    }
+
+    types::u8 *base = static_cast<types::u8 *>(reserved);
+    for (types::u8 *half : {base, base + size}) {
+        if (mmap(half, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                 fd, 0) == MAP_FAILED) {
+            debug::error("RxRing: mirror mmap failed: %s", strerror(errno));
+            munmap(reserved, 2 * size);
+            close(fd);
+            return;
+        }
+    }
+
+    // the mappings keep the memory alive
+    close(fd);
+    _base = base;
+    _mask = size - 1;
+}
+
+RxRing::~RxRing() {
+    if (_base) {
+        munmap(_base, 2 * capacity());
+    }
+}
+
+} // namespace usb
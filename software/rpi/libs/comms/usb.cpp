@@ -1,35 +1,59 @@
 #include "comms/usb.hpp"
 #include "comms.hpp"
+#include "comms/cobs.hpp"
 #include "comms/identifiers.hpp"
 #include "debug.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
+#include <cerrno>
 #include <chrono>
 #include <cstring>
 #include <dirent.h>
 #include <fcntl.h>
 #include <linux/serial.h>
+#include <poll.h>
 #include <stdarg.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <termios.h>
 #include <unistd.h>
 
 namespace usb {
 
-CDC::CDC() : _initialized(false) {}
+namespace {
+// receive time of the packet being dispatched on this (rx) thread
+thread_local types::u64 current_rx_ns = 0;
+} // namespace
+
+CDC::CDC() : _initialized(false) {
+    // every board starts with an empty table
+    for (int board = 0; board < NUM_BOARDS; board++) {
+        _all_handler_tables.push_back(std::make_unique<HandlerTable>());
+        _handler_tables[board].store(_all_handler_tables.back().get());
+    }
+}
 
 CDC::~CDC() {
-    // Clean up: close all open devices and stop threads
+    // Clean up: stop the event loop, then close all open devices
+    if (_event_thread.joinable()) {
+        _running = false;
+        wakeEventLoop();
+        _event_thread.join();
+    }
+
     std::lock_guard<std::mutex> lock(_devices_mutex);
-    for (auto &device_pair : _devices) {
-        if (device_pair.second) {
-            device_pair.second->running = false;
-            if (device_pair.second->rx_thread.joinable()) {
-                device_pair.second->rx_thread.join();
-            }
-            if (device_pair.second->fd >= 0) {
-                close(device_pair.second->fd);
-            }
+    for (auto &device : _opened_devices) {
+        if (device->fd >= 0) {
+            close(device->fd);
         }
     }
+    if (_wake_fd >= 0) {
+        close(_wake_fd);
+    }
+    if (_epoll_fd >= 0) {
+        close(_epoll_fd);
+    }
 }
 
 bool CDC::init() {
@@ -39,6 +63,10 @@ bool CDC::init() {
 
     addDebugCallbacks();
 
+    if (!_event_thread.joinable() && !startEventLoop()) {
+        return false;
+    }
+
     debug::info("Initializing scan...");
     // Scan for Pico devices
     scanDevices();
@@ -178,18 +206,31 @@ void CDC::scanDevices() {
         device->port       = port;
         device->fd         = fd;
         device->identified = false;
-        device->running    = true;
         device->board_id   = comms::BoardIdentifiers::UNKNOWN;
+        if (!device->rx_ring.valid()) {
+            close(fd);
+            continue;
+        }
 
-        // Start RX thread for this device
-        device->rx_thread =
-            std::thread(&CDC::rxThreadFunc, this, std::ref(*device));
+        // Hand it to the event loop, which owns all reads from here on
+        {
+            std::lock_guard<std::mutex> lock(_devices_mutex);
+            _opened_devices.push_back(device);
+        }
+        struct epoll_event event = {};
+        event.events             = EPOLLIN;
+        event.data.ptr           = device.get();
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            debug::error("Failed to watch %s: %s", port.c_str(),
+                         strerror(errno));
+            continue;
+        }
 
         // Send board ID request to identify the board
         types::u8 id_cmd =
             static_cast<types::u8>(comms::SendBottomPicoIdentifiers::BOARD_ID);
         debug::info("Sending BOARD_ID to %s", port.c_str());
-        writeToPico(*device, &id_cmd, nullptr, 0);
+        queueToPico(*device, id_cmd, nullptr, 0, true);
 
         // If the board is identified, add it to our devices map
         uint16_t timeout = 1000;
@@ -218,206 +259,396 @@ void CDC::scanDevices() {
                 default: identifier = "Unknown board"; break;
             }
             debug::info("Found %s on %s", identifier.c_str(), port.c_str());
+        } else {
+            debug::warn("No BOARD_ID reply from %s", port.c_str());
+            unwatch(*device);
         }
     }
 }
 
-void CDC::rxThreadFunc(PicoDevice &device) {
-    types::u8 rx_buffer[MAX_RX_BUF_SIZE];
-    types::u8 temp_buffer[MAX_RX_BUF_SIZE];
-    size_t temp_buffer_pos = 0;
-
-    while (device.running) {
-        // Try to read data
-        int bytes_avail;
-        ioctl(device.fd, FIONREAD, &bytes_avail);
-
-        if (bytes_avail > 0) {
-            int n =
-                read(device.fd, temp_buffer + temp_buffer_pos,
-                     std::min(bytes_avail, static_cast<int>(MAX_RX_BUF_SIZE -
-                                                            temp_buffer_pos)));
-            if (n > 0) {
-                temp_buffer_pos += n;
-
-                // Process complete messages
-                size_t processed_pos = 0;
-                while (
-                    processed_pos + 3 <=
-                    temp_buffer_pos) { // At least length (2 bytes) + identifier (1 byte)
-                    // Extract message length (little endian)
-                    types::u16 msg_len = temp_buffer[processed_pos] |
-                                         (temp_buffer[processed_pos + 1] << 8);
-
-                    // Check if we have a complete message
-                    if (processed_pos + 2 + msg_len <= temp_buffer_pos) {
-                        // Extract identifier
-                        types::u8 identifier = temp_buffer[processed_pos + 2];
-
-                        // Handle board identification
-                        if (identifier == static_cast<types::u8>(
-                                              comms::RecvBottomPicoIdentifiers::
-                                                  BOARD_ID) &&
-                            msg_len == 2) { // 1 for identifier + 1 for board ID
-                            comms::BoardIdentifiers board_id =
-                                static_cast<comms::BoardIdentifiers>(
-                                    temp_buffer[processed_pos + 3]);
-                            device.board_id   = board_id;
-                            device.identified = true;
-                        }
-
-                        processMessage(
-                            device.board_id, identifier,
-                            temp_buffer + processed_pos +
-                                3, // Data starts after length and identifier
-                            msg_len -
-                                1); // Length includes identifier, so subtract 1
-
-                        // Move to next message
-                        processed_pos += 2 + msg_len;
-                    } else {
-                        // Incomplete message, wait for more data
-                        break;
-                    }
-                }
+bool CDC::startEventLoop() {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd < 0) {
+        debug::error("Failed to create epoll instance: %s", strerror(errno));
+        return false;
+    }
 
-                // Move any remaining data to the beginning of the buffer
-                if (processed_pos < temp_buffer_pos) {
-                    memmove(temp_buffer, temp_buffer + processed_pos,
-                            temp_buffer_pos - processed_pos);
-                    temp_buffer_pos -= processed_pos;
-                } else {
-                    temp_buffer_pos = 0;
-                }
-            }
-        }
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wake_fd < 0) {
+        debug::error("Failed to create eventfd: %s", strerror(errno));
+        return false;
+    }
 
-        // Small delay to avoid hogging the CPU
-        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    // the wakeup fd is told apart from devices by its null pointer
+    struct epoll_event event = {};
+    event.events             = EPOLLIN;
+    event.data.ptr           = nullptr;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wake_fd, &event) < 0) {
+        debug::error("Failed to watch eventfd: %s", strerror(errno));
+        return false;
     }
+
+    _running      = true;
+    _event_thread = std::thread(&CDC::eventLoop, this);
+    return true;
 }
 
-void CDC::processMessage(comms::BoardIdentifiers board, types::u8 identifier,
-                         const types::u8 *data, types::u16 data_len) {
-    std::lock_guard<std::mutex> lock(_handlers_mutex);
+void CDC::wakeEventLoop() {
+    types::u64 one = 1;
+    if (write(_wake_fd, &one, sizeof(one)) != sizeof(one)) {
+        debug::warn("Failed to wake the USB event loop");
+    }
+}
+
+bool CDC::onEventLoop() const {
+    return std::this_thread::get_id() == _event_thread.get_id();
+}
+
+void CDC::eventLoop() {
+    struct epoll_event events[8];
 
-    switch (board) {
-        case comms::BoardIdentifiers::BOTTOM_PICO: {
-            auto it = _bottom_pico_handlers.find(identifier);
-            if (it != _bottom_pico_handlers.end()) {
-                it->second(data, data_len);
+    while (_running) {
+        int ready = epoll_wait(_epoll_fd, events, 8, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            debug::error("epoll_wait failed: %s", strerror(errno));
             break;
         }
-        case comms::BoardIdentifiers::MIDDLE_PICO: {
-            auto it = _middle_pico_handlers.find(identifier);
-            if (it != _middle_pico_handlers.end()) {
-                it->second(data, data_len);
+
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.ptr == nullptr) {
+                // wakeup, drain the counter, _running is checked by the loop
+                types::u64 count;
+                while (read(_wake_fd, &count, sizeof(count)) > 0) {
+                }
+                continue;
             }
-            break;
-        }
-        case comms::BoardIdentifiers::TOP_PICO: {
-            auto it = _top_pico_handlers.find(identifier);
-            if (it != _top_pico_handlers.end()) {
-                it->second(data, data_len);
+
+            PicoDevice &device = *static_cast<PicoDevice *>(events[i].data.ptr);
+            bool alive         = true;
+            if (events[i].events & EPOLLIN) {
+                alive = receive(device);
             }
-            break;
+            if (!alive || (events[i].events & (EPOLLHUP | EPOLLERR))) {
+                debug::error("Lost device %s", device.port.c_str());
+                unwatch(device);
+            }
+        }
+    }
+}
+
+bool CDC::receive(PicoDevice &device) {
+    RxRing &ring = device.rx_ring;
+
+    // the fd is non blocking, read until it is drained
+    while (true) {
+        ssize_t n = read(device.fd, ring.write_ptr(), ring.writable());
+        if (n == 0) {
+            return false; // hung up
         }
-        case comms::BoardIdentifiers::UNKNOWN: {
-            // Handle messages from unknown board types
-            auto it = _unknown_pico_handlers.find(identifier);
-            if (it != _unknown_pico_handlers.end()) {
-                it->second(data, data_len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
             }
-            break;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        // every packet completed by this read arrived now
+        ring.commit(n);
+        parsePackets(device, timer::ns());
+
+        // full of one packet that can never complete, drop it to resync
+        if (ring.writable() == 0) {
+            debug::warn("Unterminated packet from %s, dropped",
+                        device.port.c_str());
+            ring.consume(ring.readable());
+            _bad_frames.fetch_add(1, std::memory_order_relaxed);
         }
     }
 }
 
-bool CDC::writeToPico(PicoDevice &device, const types::u8 *identifier_ptr,
-                      const types::u8 *data, types::u16 data_len) {
-    types::u16 reported_len =
-        data_len + sizeof(*identifier_ptr); // +1 for identifier
-    types::u16 packet_len = sizeof(reported_len) + reported_len;
+#ifdef USB_FRAMING_COBS
+void CDC::parsePackets(PicoDevice &device, types::u64 rx_ns) {
+    RxRing &ring = device.rx_ring;
+
+    while (ring.readable() > 0) {
+        // the ring is mirrored, so a frame is always contiguous
+        types::u8 *frame = ring.read_ptr();
+        types::u8 *end   = static_cast<types::u8 *>(
+            memchr(frame, comms::cobs::DELIMITER, ring.readable()));
+        if (!end) {
+            break; // incomplete frame, wait for more data
+        }
 
-    if (packet_len > MAX_TX_BUF_SIZE) {
-        return false;
+        size_t frame_len  = end - frame;
+        size_t packet_len = comms::cobs::decode(frame, frame_len);
+        if (packet_len > 0) {
+            handlePacket(device, frame, packet_len, rx_ns);
+        } else if (frame_len > 0) {
+            // corrupt, skip to the delimiter (empty frames are padding)
+            _bad_frames.fetch_add(1, std::memory_order_relaxed);
+        }
+        ring.consume(frame_len + 1);
     }
+}
+#else
+void CDC::parsePackets(PicoDevice &device, types::u64 rx_ns) {
+    RxRing &ring = device.rx_ring;
+
+    // At least length (2 bytes) + identifier (1 byte)
+    while (ring.readable() >= 3) {
+        // Extract message length (little endian), includes the identifier
+        const types::u8 *packet = ring.read_ptr();
+        types::u16 msg_len      = packet[0] | (packet[1] << 8);
+
+        if (msg_len == 0) {
+            // no identifier, cannot be a packet
+            _bad_frames.fetch_add(1, std::memory_order_relaxed);
+            ring.consume(2);
+            continue;
+        }
 
-    // Prepare packet
-    types::u8 tx_buffer[MAX_TX_BUF_SIZE] = {0};
+        // Check if we have a complete message
+        if (ring.readable() < 2 + (size_t)msg_len) {
+            break; // Incomplete message, wait for more data
+        }
 
-    // Write length (little endian)
-    memcpy(tx_buffer, &reported_len, sizeof(reported_len));
+        handlePacket(device, packet + 2, msg_len, rx_ns);
+        ring.consume(2 + msg_len);
+    }
+}
+#endif
+
+void CDC::handlePacket(PicoDevice &device, const types::u8 *packet,
+                       size_t packet_len, types::u64 rx_ns) {
+    types::u8 identifier = packet[0];
+
+    // Handle board identification
+    if (identifier ==
+            static_cast<types::u8>(comms::RecvBottomPicoIdentifiers::BOARD_ID) &&
+        packet_len == 2) { // 1 for identifier + 1 for board ID
+        device.board_id   = static_cast<comms::BoardIdentifiers>(packet[1]);
+        device.identified = true;
+    }
 
-    // Write identifier
-    tx_buffer[sizeof(reported_len)] = *identifier_ptr;
+    // Data starts after the identifier, handlers see it in place
+    processMessage(device.board_id, identifier, packet + 1, packet_len - 1,
+                   rx_ns);
+}
 
-    memcpy(&tx_buffer[3], data, data_len);
+void CDC::unwatch(PicoDevice &device) {
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, device.fd, nullptr);
+}
 
-    // Send packet
-    std::lock_guard<std::mutex> lock(device.tx_mutex);
-    return write(device.fd, tx_buffer, packet_len) == packet_len;
+types::u64 CDC::rxTimestamp() { return current_rx_ns; }
+
+void CDC::processMessage(comms::BoardIdentifiers board, types::u8 identifier,
+                         const types::u8 *data, types::u16 data_len,
+                         types::u64 rx_ns) {
+    current_rx_ns = rx_ns;
+
+    // the board id comes off the wire, anything unexpected is unknown
+    int index = static_cast<int>(board);
+    if (index >= NUM_BOARDS) {
+        index = static_cast<int>(comms::BoardIdentifiers::UNKNOWN);
+    }
+
+    const HandlerTable *table =
+        _handler_tables[index].load(std::memory_order_acquire);
+    const MessageCallback &handler = table->handlers[identifier];
+    if (handler) {
+        handler(data, data_len);
+    }
+
+    // from the read to the handler returning
+    trace::record("usb_rx", rx_ns, timer::ns(), identifier);
 }
 
-bool CDC::writeToBottomPico(comms::SendBottomPicoIdentifiers identifier,
-                            const types::u8 *data, types::u16 data_len) {
-    std::lock_guard<std::mutex> lock(_devices_mutex);
-    auto it = _devices.find(comms::BoardIdentifiers::BOTTOM_PICO);
-    if (it == _devices.end()) {
+bool CDC::queueToPico(PicoDevice &device, types::u8 identifier,
+                      const types::u8 *data, types::u16 data_len,
+                      bool flush_now) {
+    size_t packet_len = data_len + sizeof(identifier);
+    if (packet_len > MAX_TX_BUF_SIZE) {
         return false;
     }
+#ifdef USB_FRAMING_COBS
+    size_t max_len = comms::cobs::max_frame_size(packet_len);
+#else
+    size_t max_len = sizeof(types::u16) + packet_len;
+#endif
+
+    std::lock_guard<std::mutex> lock(device.tx_mutex);
+    bool ok = true;
+    if (device.tx_len + max_len > TX_QUEUE_SIZE) {
+        ok = flushQueue(device);
+    }
+
+    // Encode straight onto the end of the queue
+    types::u8 *out = device.tx_queue + device.tx_len;
+#ifdef USB_FRAMING_COBS
+    comms::cobs::Encoder encoder(out);
+    encoder.write(identifier);
+    encoder.write(data, data_len);
+    device.tx_len += encoder.finish();
+#else
+    // length (little endian), identifier, payload
+    types::u16 reported_len = packet_len;
+    memcpy(out, &reported_len, sizeof(reported_len));
+    out[sizeof(reported_len)] = identifier;
+    if (data_len > 0) {
+        memcpy(out + sizeof(reported_len) + sizeof(identifier), data,
+               data_len);
+    }
+    device.tx_len += max_len;
+#endif
 
-    types::u8 id = static_cast<types::u8>(identifier);
-    return writeToPico(*(it->second), &id, data, data_len);
+    if (flush_now || device.tx_len >= TX_FLUSH_THRESHOLD) {
+        ok = flushQueue(device) && ok;
+    }
+    return ok;
 }
 
-bool CDC::writeToMiddlePico(comms::SendMiddlePicoIdentifiers identifier,
-                            const types::u8 *data, types::u16 data_len) {
-    std::lock_guard<std::mutex> lock(_devices_mutex);
-    auto it = _devices.find(comms::BoardIdentifiers::MIDDLE_PICO);
-    if (it == _devices.end()) {
+bool CDC::flushQueue(PicoDevice &device) {
+    size_t sent = 0;
+    while (sent < device.tx_len) {
+        ssize_t written =
+            write(device.fd, device.tx_queue + sent, device.tx_len - sent);
+        if (written > 0) {
+            sent += written;
+            continue;
+        }
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // The fd is non-blocking, wait (briefly) for the tty to drain
+        struct pollfd pfd = {device.fd, POLLOUT, 0};
+        if (written < 0 && errno == EAGAIN &&
+            poll(&pfd, 1, TX_TIMEOUT_MS) > 0 && (pfd.revents & POLLOUT)) {
+            continue;
+        }
+
+        debug::warn("Dropped %zu queued bytes to %s", device.tx_len - sent,
+                    device.port.c_str());
+        device.tx_len = 0;
         return false;
     }
+    device.tx_len = 0;
+    return true;
+}
 
-    types::u8 id = static_cast<types::u8>(identifier);
-    return writeToPico(*(it->second), &id, data, data_len);
+std::shared_ptr<CDC::PicoDevice>
+CDC::findDevice(comms::BoardIdentifiers board) {
+    std::lock_guard<std::mutex> lock(_devices_mutex);
+    auto it = _devices.find(board);
+    return it == _devices.end() ? nullptr : it->second;
+}
+
+bool CDC::writeToBottomPico(comms::SendBottomPicoIdentifiers identifier,
+                            const types::u8 *data, types::u16 data_len) {
+    auto device = findDevice(comms::BoardIdentifiers::BOTTOM_PICO);
+    return device && queueToPico(*device, static_cast<types::u8>(identifier),
+                                 data, data_len, true);
+}
+
+bool CDC::writeToMiddlePico(comms::SendMiddlePicoIdentifiers identifier,
+                            const types::u8 *data, types::u16 data_len) {
+    auto device = findDevice(comms::BoardIdentifiers::MIDDLE_PICO);
+    return device && queueToPico(*device, static_cast<types::u8>(identifier),
+                                 data, data_len, true);
 }
 
 bool CDC::writeToTopPico(comms::SendTopPicoIdentifiers identifier,
                          const types::u8 *data, types::u16 data_len) {
-    std::lock_guard<std::mutex> lock(_devices_mutex);
-    auto it = _devices.find(comms::BoardIdentifiers::TOP_PICO);
-    if (it == _devices.end()) {
+    auto device = findDevice(comms::BoardIdentifiers::TOP_PICO);
+    return device && queueToPico(*device, static_cast<types::u8>(identifier),
+                                 data, data_len, true);
+}
+
+bool CDC::queueToBottomPico(comms::SendBottomPicoIdentifiers identifier,
+                            const types::u8 *data, types::u16 data_len) {
+    auto device = findDevice(comms::BoardIdentifiers::BOTTOM_PICO);
+    return device && queueToPico(*device, static_cast<types::u8>(identifier),
+                                 data, data_len, false);
+}
+
+bool CDC::queueToMiddlePico(comms::SendMiddlePicoIdentifiers identifier,
+                            const types::u8 *data, types::u16 data_len) {
+    auto device = findDevice(comms::BoardIdentifiers::MIDDLE_PICO);
+    return device && queueToPico(*device, static_cast<types::u8>(identifier),
+                                 data, data_len, false);
+}
+
+bool CDC::queueToTopPico(comms::SendTopPicoIdentifiers identifier,
+                         const types::u8 *data, types::u16 data_len) {
+    auto device = findDevice(comms::BoardIdentifiers::TOP_PICO);
+    return device && queueToPico(*device, static_cast<types::u8>(identifier),
+                                 data, data_len, false);
+}
+
+bool CDC::flush(comms::BoardIdentifiers board) {
+    auto device = findDevice(board);
+    if (!device) {
         return false;
     }
+    std::lock_guard<std::mutex> lock(device->tx_mutex);
+    return flushQueue(*device);
+}
+
+bool CDC::flush() {
+    std::vector<std::shared_ptr<PicoDevice>> devices;
+    {
+        std::lock_guard<std::mutex> lock(_devices_mutex);
+        for (auto &entry : _devices) {
+            devices.push_back(entry.second);
+        }
+    }
+
+    bool ok = true;
+    for (auto &device : devices) {
+        std::lock_guard<std::mutex> lock(device->tx_mutex);
+        ok = flushQueue(*device) && ok;
+    }
+    return ok;
+}
+
+void CDC::registerHandler(comms::BoardIdentifiers board, types::u8 identifier,
+                          MessageCallback callback) {
+    std::lock_guard<std::mutex> lock(_handlers_mutex);
+    int index = static_cast<int>(board);
+
+    auto table = std::make_unique<HandlerTable>(
+        *_handler_tables[index].load(std::memory_order_relaxed));
+    table->handlers[identifier] = std::move(callback);
 
-    types::u8 id = static_cast<types::u8>(identifier);
-    return writeToPico(*(it->second), &id, data, data_len);
+    _handler_tables[index].store(table.get(), std::memory_order_release);
+    _all_handler_tables.push_back(std::move(table));
 }
 
 void CDC::registerBottomPicoHandler(comms::RecvBottomPicoIdentifiers identifier,
                                     MessageCallback callback) {
-    std::lock_guard<std::mutex> lock(_handlers_mutex);
-    _bottom_pico_handlers[static_cast<types::u8>(identifier)] = callback;
+    registerHandler(comms::BoardIdentifiers::BOTTOM_PICO,
+                    static_cast<types::u8>(identifier), std::move(callback));
 }
 
 void CDC::registerMiddlePicoHandler(comms::RecvMiddlePicoIdentifiers identifier,
                                     MessageCallback callback) {
-    std::lock_guard<std::mutex> lock(_handlers_mutex);
-    _middle_pico_handlers[static_cast<types::u8>(identifier)] = callback;
+    registerHandler(comms::BoardIdentifiers::MIDDLE_PICO,
+                    static_cast<types::u8>(identifier), std::move(callback));
 }
 
 void CDC::registerTopPicoHandler(comms::RecvTopPicoIdentifiers identifier,
                                  MessageCallback callback) {
-    std::lock_guard<std::mutex> lock(_handlers_mutex);
-    _top_pico_handlers[static_cast<types::u8>(identifier)] = callback;
+    registerHandler(comms::BoardIdentifiers::TOP_PICO,
+                    static_cast<types::u8>(identifier), std::move(callback));
 }
 
 void CDC::registerUnknownPicoHandler(types::u8 identifier,
                                      MessageCallback callback) {
-    std::lock_guard<std::mutex> lock(_handlers_mutex);
-    _unknown_pico_handlers[identifier] = callback;
+    registerHandler(comms::BoardIdentifiers::UNKNOWN, identifier,
+                    std::move(callback));
 }
 
 } // namespace usb
@@ -69,11 +69,8 @@ void MotionController::controlThreadWorker() {
         Pos pos  = _processor.current_pos;
         auto res = translate(std::make_tuple(0, 0.1f));
 
-        // send motor values to the motors
-        motors::command_motor(1, std::get<0>(res));
-        motors::command_motor(2, std::get<1>(res));
-        motors::command_motor(3, std::get<2>(res));
-        motors::command_motor(4, std::get<3>(res));
+        // send motor values to the motors, all four in one update
+        motors::command_all_motors_motion_controller(res);
 
         // Prevent CPU thrashing with a small sleep
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -2,6 +2,7 @@
 
 namespace motors {
 
+const int MOTOR_COUNT                = 4;
 const bool DIRECTIONS[]              = {true, true, false, false};
 const int MOTION_CONTROL_MOTOR_MAP[] = {1, 4, 2, 3};
 const int MOTOR_MAX_DUTY_CYCLE       = 2000;
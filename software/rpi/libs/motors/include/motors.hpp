@@ -1,5 +1,6 @@
 #pragma once
 #include "types.hpp"
+#include <tuple>
 
 namespace motors {
 
@@ -8,6 +9,14 @@ struct MotorRecvData {
     types::i16 duty_cycle;
 } __attribute__((packed));
 
+// MOTOR_DRIVER_CMD_ALL, applied by the bottom pico in one go
+// ^ SYNC WITH THE BOTTOM PICO (src/actions/motors.hpp) ^
+struct MotorAllRecvData {
+    types::u32 sequence;     // +1 per update, starts at 1
+    types::u64 timestamp_ns; // timer::ns() when sent
+    types::i16 duty_cycles[4]; // by motor id - 1
+} __attribute__((packed));
+
 /**
  * @brief Takes in a motor id and a duty cycle and sends the command to the motor driver
  * ^ Accounts for all the motor direction and mapping issues
@@ -31,6 +40,25 @@ bool command_motor(uint8_t id, types::i16 duty_cycle);
  */
 bool command_motor_motion_controller(uint8_t id, types::i16 duty_cycle);
 
+/**
+ * @brief Sends the duty cycles of all four motors in one command, which the
+ * motor driver applies together
+ * ^ Accounts for all the motor direction and mapping issues
+ * ^ Maps the motors to the ones used in the motion control
+ * 
+ * @param duty_cycles Duty cycles of motion control motors 1 to 4
+ * @return true 
+ * @return false if any duty cycle is too high (nothing is sent)
+ */
+bool command_all_motors_motion_controller(const types::i16 duty_cycles[4]);
+
+/**
+ * @brief Same, from a MotionController command (-1 to 1 per motor), scaled
+ * to MOTOR_MAX_DUTY_CYCLE
+ */
+bool command_all_motors_motion_controller(
+    const std::tuple<types::f32, types::f32, types::f32, types::f32> &commands);
+
 void translate(types::Vec2f32 vec);
 void translate_with_target_heading(types::f32 speed,
                                    types::f32 translate_heading,
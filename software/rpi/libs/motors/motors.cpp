@@ -4,6 +4,10 @@
 #include "debug.hpp"
 #include "motion.hpp"
 #include "motors.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
+#include <atomic>
+#include <cstdlib>
 #include <unistd.h>
 
 using namespace types;
@@ -38,23 +42,64 @@ bool command_motor_motion_controller(uint8_t id, types::i16 duty_cycle) {
     return command_motor(MOTION_CONTROL_MOTOR_MAP[id - 1], duty_cycle);
 }
 
+bool command_all_motors_motion_controller(const types::i16 duty_cycles[4]) {
+    static std::atomic<u32> sequence{0};
+
+    MotorAllRecvData motor_data = {};
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        if (std::abs(duty_cycles[i]) > MOTOR_MAX_DUTY_CYCLE) {
+            debug::error("Motor duty cycle %d is too high, max is %d",
+                         duty_cycles[i], MOTOR_MAX_DUTY_CYCLE);
+            return false;
+        }
+
+        int id = MOTION_CONTROL_MOTOR_MAP[i];
+        motor_data.duty_cycles[id - 1] =
+            DIRECTIONS[id - 1] ? duty_cycles[i] : -duty_cycles[i];
+    }
+    motor_data.sequence     = ++sequence;
+    motor_data.timestamp_ns = timer::ns();
+
+    return comms::USB_CDC.writeToBottomPico(
+        comms::SendBottomPicoIdentifiers::MOTOR_DRIVER_CMD_ALL,
+        reinterpret_cast<uint8_t *>(&motor_data), sizeof(motor_data));
+}
+
+bool command_all_motors_motion_controller(
+    const std::tuple<f32, f32, f32, f32> &commands) {
+    i16 duty_cycles[MOTOR_COUNT] = {
+        (i16)(std::get<0>(commands) * MOTOR_MAX_DUTY_CYCLE),
+        (i16)(std::get<1>(commands) * MOTOR_MAX_DUTY_CYCLE),
+        (i16)(std::get<2>(commands) * MOTOR_MAX_DUTY_CYCLE),
+        (i16)(std::get<3>(commands) * MOTOR_MAX_DUTY_CYCLE)};
+    return command_all_motors_motion_controller(duty_cycles);
+}
+
+namespace {
+// how old the newest camera observation is when the motors act on it
+void trace_actuation(u64 start_ns) {
+    u64 now_ns = timer::ns();
+    trace::record("motor_command", start_ns, now_ns);
+
+    u64 observation_ns = trace::observation();
+    if (observation_ns) {
+        trace::record("observation_to_motor", observation_ns, now_ns);
+    }
+}
+} // namespace
+
 void translate(types::Vec2f32 vec) {
+    u64 start_ns = timer::ns();
     auto commands =
         motion_controller.translate(std::tuple<f32, f32>(vec.x, vec.y));
-    motors::command_motor_motion_controller(1, std::get<0>(commands) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
-    motors::command_motor_motion_controller(2, std::get<1>(commands) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
-    motors::command_motor_motion_controller(3, std::get<2>(commands) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
-    motors::command_motor_motion_controller(4, std::get<3>(commands) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
+    command_all_motors_motion_controller(commands);
     debug::info("Motor commands: %d %d %d %d",
                 (int)(std::get<0>(commands) * MOTOR_MAX_DUTY_CYCLE),
                 (int)(std::get<1>(commands) * MOTOR_MAX_DUTY_CYCLE),
                 (int)(std::get<2>(commands) * MOTOR_MAX_DUTY_CYCLE),
                 (int)(std::get<3>(commands) *
                       MOTOR_MAX_DUTY_CYCLE)); // 4.... (big number) 0 1 0
+    trace_actuation(start_ns);
 }
 
 std::tuple<f32, f32, f32, f32> operator+(std::tuple<f32, f32, f32, f32> &a,
@@ -67,6 +112,7 @@ std::tuple<f32, f32, f32, f32> operator+(std::tuple<f32, f32, f32, f32> &a,
 void translate_with_target_heading(f32 speed, f32 translate_heading,
                                    f32 orientation_heading,
                                    const Vec2f32 &line_evading) {
+    u64 start_ns = timer::ns();
     auto translate_command =
         motion_controller.move_heading(0, -translate_heading, speed);
     auto line_evade_command = motion_controller.translate(line_evading);
@@ -95,14 +141,8 @@ void translate_with_target_heading(f32 speed, f32 translate_heading,
                             std::get<3>(summed_command) / max_duty_cycle);
     }
 
-    motors::command_motor_motion_controller(1, std::get<0>(summed_command) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
-    motors::command_motor_motion_controller(2, std::get<1>(summed_command) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
-    motors::command_motor_motion_controller(3, std::get<2>(summed_command) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
-    motors::command_motor_motion_controller(4, std::get<3>(summed_command) *
-                                                   MOTOR_MAX_DUTY_CYCLE);
+    command_all_motors_motion_controller(summed_command);
+    trace_actuation(start_ns);
 
     // debug::info("MOTOR SUMMED_COMMAND: %f %f %f %f",
     //             std::get<0>(summed_command) * MOTOR_MAX_DUTY_CYCLE,
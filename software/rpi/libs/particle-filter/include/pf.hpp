@@ -1,61 +1,236 @@
 #pragma once
 #include <iostream>
-#include <random>
 #include <vector>
 #include <tuple>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include "mpsc_ring.hpp"
+#include "pf_rng.hpp"
+#include "timer.hpp"
+
+enum ResampleScheme {
+    // one uniform draw, N evenly spaced pointers (lowest variance)
+    RESAMPLE_SYSTEMATIC = 0,
+    // one uniform draw per 1/N stratum
+    RESAMPLE_STRATIFIED = 1,
+};
+
+/**
+ * @brief KLD-sampling bounds: each resample picks N so that, with
+ * probability 1 - delta, the particles are within epsilon (KL divergence)
+ * of the posterior, given the number of (x, y, theta) bins it occupies
+ */
+struct KldConfig {
+    int min_particles;
+    int max_particles;
+    double epsilon   = 0.05;
+    double z         = 2.326;  // upper 1 - delta quantile of N(0, 1), delta = 0.01
+    float bin_xy     = 10.0f;  // field units
+    float bin_theta  = 10.0f * 3.14159265f / 180.0f;
+};
+
+struct FilterStats {
+    int particles     = 0;  // current N
+    int occupied_bins = 0;  // bins counted by the last adaptive resample
+    uint64_t predict_ns  = 0;  // last predict
+    uint64_t resample_ns = 0;  // last resample that ran
+};
+
+/**
+ * @brief Measurement model scoring poses directly against a camera frame
+ * Fills losses[i] in [0, 1] (lower is better) for the pose (xs[i], ys[i],
+ * thetas[i]), i in [0, count). Called from several threads at once, on
+ * disjoint ranges.
+ */
+using PoseLoss = std::function<void(const float *xs, const float *ys, const float *thetas,
+                                    int count, float *losses)>;
+
+enum FilterInputKind {
+    INPUT_ODOMETRY = 0,    // a, b: x, y change in the robot frame
+    INPUT_IMU = 1,         // a: heading change
+    INPUT_CAMERA_POSE = 2, // a, b, c: solved x, y, heading
+    INPUT_CAMERA_LOSS = 3, // a: index into the pending frame losses
+};
+
+// one timestamped sensor input, timer::ns() clock
+struct FilterInput {
+    uint64_t timestamp_ns;
+    FilterInputKind kind;
+    float a, b, c;
+};
 
 struct Particle {
-    double x, y, theta;  // Position (x, y) and orientation theta
-    double weight;
+    float x, y, theta;  // Position (x, y) and orientation theta
+    float weight;
 };
 
 class ParticleFilter {
 private:
-    std::vector<Particle> particles;
-    std::default_random_engine gen;
-    int data_size = 0;
-    double cumulative_theta = 0.0;
-    std::vector<double> theta_changes;
-    std::vector<std::tuple<double, double> > position_changes;
-    std::vector<std::tuple<double, double, double> > position_archive; 
-    double provisional_x = 0.0, provisional_y = 0.0;
-    
-public:
-    std::vector<int> alias;
-    std::vector<double> prob;
-    bool added_new_input = false;
+    // particles as a structure of arrays, so every update is a straight,
+    // vectorizable loop over each field
+    std::vector<float> xs, ys, thetas, weights;
+
+    // resampling draws, and motion noise, 3 standard normals (x, y, theta)
+    // per particle, laid out per chunk
+    CounterRng rng;
+    std::vector<float> noise;
+
+    // particles are split into contiguous chunks run on the shared
+    // ThreadPool, each with its own random stream, so a seed and chunk count
+    // always reproduce the same run
+    int num_chunks;
+    std::vector<CounterRng> chunk_rngs;
+    std::vector<double> chunk_sums; // per chunk partial sums, 4 per chunk
+
+    // KLD-sampling, off (N fixed) until set_kld, every buffer is reserved
+    // for max_particles so changing N never allocates
+    bool kld_enabled = false;
+    KldConfig kld;
+    std::vector<uint64_t> bins; // open addressing set, stamp << 32 | key
+    uint32_t bin_stamp = 0;
+    FilterStats filter_stats;
+
+    // occupied bins of the particles a resample to max_particles would pick
+    int count_occupied_bins();
+    int kld_particle_count(int occupied_bins) const;
+    void reserve_particles(int capacity);
+
+    int chunk_begin(int chunk) const { return (int)((int64_t)size() * chunk / num_chunks); }
+    template <typename Fn> void for_each_chunk(Fn &&fn) {
+        if (num_chunks == 1) {
+            fn(0);
+            return;
+        }
+        // wrapped by reference, which std::function stores without allocating
+        parallel_chunks(std::ref(fn));
+    }
+    void parallel_chunks(const std::function<void(int)> &fn);
+
+    // resampling gathers into these, then swaps them in (no allocation)
+    std::vector<float> next_xs, next_ys, next_thetas;
+
+    // sensor inputs, pushed from the producer threads and drained in
+    // timestamp order by predict
+    MpscRing<FilterInput> inputs;
+    std::vector<FilterInput> drained;
+    std::atomic<uint64_t> dropped{0};
+    uint64_t last_measurement_ns = 0;
+    uint64_t late = 0;
+
+    // frame losses only live on the predict thread, the ring refers to them
+    std::vector<std::tuple<PoseLoss, double> > pending_losses;
+    std::vector<uint64_t> pending_timestamps;
+    std::vector<float> losses;
+
+    // motion update of a chunk's particles by one buffered input
+    void move_particles(int chunk, float x_change, float y_change, float theta_change,
+                        float std_dev_pos, float std_dev_theta);
+
+    // weight a chunk's particles against a camera position, returns their sum
+    double weigh_particles(int chunk, float meas_x, float meas_y, float meas_theta,
+                           float std_dev_camera);
+
+    // weight a chunk's particles by their frame loss, returns their sum
+    double weigh_particles_loss(int chunk, const PoseLoss &loss, float std_dev_loss);
+
+    static FilterInput input_at(FilterInputKind kind, uint64_t timestamp_ns,
+                                float a = 0.0f, float b = 0.0f, float c = 0.0f);
+    bool push_input(const FilterInput &input);
+
+    // divide every weight by their sum
+    void scale_weights(double sum_weights);
 
-    ParticleFilter(int num_particles, double x_min, double x_max, double y_min, double y_max);
+public:
+    // sensor inputs buffered between two predicts
+    static constexpr int INPUT_CAPACITY = 1024;
+    // camera frame losses buffered between two predicts
+    static constexpr size_t MAX_PENDING_LOSSES = 8;
+
+    /**
+     * @param seed Seeds the particle spread, the motion noise and resampling
+     * @param num_chunks Parallel chunks per update, 0 for one per core of the
+     * shared ThreadPool, 1 to run on the calling thread only
+     */
+    ParticleFilter(int num_particles, double x_min, double x_max, double y_min, double y_max,
+                   uint64_t seed = 0, int num_chunks = 0);
+
+    /**
+     * @brief Spread the particles around a pose estimate (for example a
+     * goalpost pose prior) instead of over the whole field, when lost
+     * @param cov_xx, cov_xy, cov_yy Position covariance
+     */
+    void reinitialize(float x, float y, float theta, float cov_xx, float cov_xy, float cov_yy,
+                      float std_dev_theta);
+
+    int size() const { return (int)xs.size(); }
+    Particle particle(int i) const { return {xs[i], ys[i], thetas[i], weights[i]}; }
 
     double normalize_angle(double angle);
 
     void predict(double std_dev_coords, double std_dev_camera, double std_dev_theta);
 
-    void predict_old(double delta_x, double delta_y, double delta_theta, double std_dev);
-       
-    void update(double meas_x, double meas_y, double std_dev);
+    /**
+     * @brief Sensor inputs, safe to push from any thread (lock-free, no
+     * allocation), applied in timestamp order by the next predict
+     * @return false if the input buffer is full and the input was dropped
+     */
+    bool push_odometry(float x_change, float y_change, uint64_t timestamp_ns = timer::ns());
+    bool push_imu(float theta_change, uint64_t timestamp_ns = timer::ns());
+    bool push_camera(float x, float y, float theta, uint64_t timestamp_ns = timer::ns());
 
+    // push_* stamped now
     void update_mouse(std::tuple<double, double> delta_position);
 
     void update_imu(double delta_theta);
 
     void update_camera(std::tuple<double, double, double> new_position);
-    void resample();
-    void check_added_new_input();
-
-    void normalize_weights();
-
-    std::vector<double> build_cdf();
-
-    int sample_cdf(const std::vector<double>& cdf, std::mt19937& rng);
 
-    void build_alias_table();
+    /**
+     * @brief Weigh every particle by the loss of its own pose against this
+     * step's frame, instead of against one solved pose (no pose search)
+     * @param loss Batch loss of the frame, for example
+     * CamProcessor::calculate_loss_batch on its distance map
+     * @param std_dev_loss Loss of a pose one standard deviation off
+     * @param timestamp_ns Sensor timestamp of the frame
+     * ^ Only from the thread that calls predict, loss must stay valid until
+     * then
+     * ^ Frames past MAX_PENDING_LOSSES per predict are dropped (counted by
+     * dropped_inputs)
+     */
+    void update_camera_loss(PoseLoss loss, double std_dev_loss,
+                            uint64_t timestamp_ns = timer::ns());
 
-    int sample_alias(std::mt19937& rng);
+    void normalize_weights();
 
-    void resample_particles(std::mt19937& rng);
+    // 1 / sum(w^2) of the normalized weights, N when uniform, 1 when one
+    // particle holds all the weight
+    double effective_sample_size();
+
+    /**
+     * @brief O(N) resampling into preallocated buffers, only once the
+     * weights have degenerated (effective sample size below
+     * min_effective_fraction * N, 1 always resamples)
+     * @return whether the particles were resampled
+     */
+    bool resample_particles(ResampleScheme scheme = RESAMPLE_SYSTEMATIC,
+                            double min_effective_fraction = 0.5);
+
+    /**
+     * @brief Adapt N between the config's bounds on every resample, to
+     * follow the actual uncertainty
+     */
+    void set_kld(const KldConfig &config);
+
+    // N, bins and step timings, also recorded as "pf_predict" and
+    // "pf_resample" trace spans
+    const FilterStats &stats() const { return filter_stats; }
+
+    // inputs (and frame losses) dropped on a full buffer / applied after a later camera input
+    // (too late to go before it, they count towards the next one)
+    uint64_t dropped_inputs() const { return dropped.load(); }
+    uint64_t late_inputs() const { return late; }
 
     double calculate_entropy();
 
@@ -63,7 +238,3 @@ public:
 
     Particle estimate_position();
 };
-
-
-
-
@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Branch free float approximations, written so that loops calling them
+// auto-vectorize (NEON on the Pi). Accurate to a few float ulps over the
+// ranges the particle filter uses, which is far below its noise.
+namespace pf_math {
+
+constexpr float PI         = 3.14159265358979f;
+constexpr float TWO_PI     = 6.28318530717959f;
+constexpr float INV_TWO_PI = 0.159154943091895f;
+
+inline float as_float(int32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline int32_t as_int(float value) {
+    int32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// round to nearest, without depending on the rounding mode or SSE4.1
+inline int32_t round_to_int(float value) {
+    return (int32_t)(value + (value >= 0.0f ? 0.5f : -0.5f));
+}
+
+// angle wrapped to [-pi, pi]
+inline float wrap_angle(float angle) {
+    return angle - TWO_PI * (float)round_to_int(angle * INV_TWO_PI);
+}
+
+// sin and cos of any angle within +-1e5 rad
+inline void sincos(float angle, float &sin_out, float &cos_out) {
+    // reduce to r in [-pi/4, pi/4], angle = r + quadrant * pi/2
+    int32_t quadrant = round_to_int(angle * 0.636619772367581f);
+    float r = (angle - (float)quadrant * 1.5707963705062866f) +
+              (float)quadrant * 4.37113900018624e-8f;
+    float r2 = r * r;
+
+    float s = r + r * r2 *
+                      (-1.66666667e-1f +
+                       r2 * (8.33333333e-3f + r2 * -1.98412698e-4f));
+    float c = 1.0f +
+              r2 * (-0.5f + r2 * (4.16666667e-2f +
+                                  r2 * (-1.38888889e-3f +
+                                        r2 * 2.48015873e-5f)));
+
+    // rotate by the quadrant
+    bool swap   = quadrant & 1;
+    float sin_r = swap ? c : s;
+    float cos_r = swap ? s : c;
+    sin_out     = (quadrant & 2) ? -sin_r : sin_r;
+    cos_out     = ((quadrant + 1) & 2) ? -cos_r : cos_r;
+}
+
+// e^x, clamped to the float range (e^-87 underflows to ~0)
+inline float exp(float x) {
+    x = std::min(std::max(x, -87.0f), 88.0f);
+
+    // e^x = 2^t, split t into integer k and fraction f in [0, 1)
+    float t   = x * 1.44269504088896f;
+    int32_t k = (int32_t)t;
+    k -= (float)k > t; // truncation rounds negatives up
+    float f = t - (float)k;
+
+    // 2^f, minimax on [0, 1)
+    float p = 1.0f +
+              f * (6.93147182e-1f +
+                   f * (2.40226507e-1f +
+                        f * (5.55041087e-2f +
+                             f * (9.61812911e-3f + f * 1.33335581e-3f))));
+    return p * as_float((k + 127) << 23);
+}
+
+// natural log of a positive, normal x
+inline float log(float x) {
+    int32_t bits     = as_int(x);
+    int32_t exponent = ((bits >> 23) & 0xff) - 127;
+    float mantissa   = as_float((bits & 0x7fffff) | 0x3f800000); // [1, 2)
+
+    // ln(m) = 2 atanh(z), z = (m - 1) / (m + 1) in [0, 1/3)
+    float z  = (mantissa - 1.0f) / (mantissa + 1.0f);
+    float z2 = z * z;
+    float ln_mantissa =
+        2.0f * z *
+        (1.0f + z2 * (3.33333333e-1f +
+                      z2 * (2.0e-1f + z2 * (1.42857143e-1f +
+                                            z2 * 1.11111111e-1f))));
+    return ln_mantissa + (float)exponent * 6.93147180559945e-1f;
+}
+
+} // namespace pf_math
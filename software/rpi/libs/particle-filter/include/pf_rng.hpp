@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Counter based random numbers: draw n of a stream is a pure hash of
+ * (key, n), so batches fill in any order, vectorize, and can be split across
+ * threads without sharing state
+ */
+class CounterRng {
+public:
+    explicit CounterRng(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        key_lo = hash(static_cast<uint32_t>(seed) ^ 0x9e3779b9u);
+        key_hi = hash(static_cast<uint32_t>(seed >> 32) ^ key_lo);
+        counter = 0;
+    }
+
+    // independent stream number `stream` of a seed, one per worker chunk
+    void reseed(uint64_t seed, uint32_t stream) {
+        reseed(seed);
+        key_hi = hash(key_hi ^ hash(stream + 0x632be5abu));
+    }
+
+    // draws taken so far, the next batch starts here
+    uint64_t position() const { return counter; }
+    void skip(uint64_t draws) { counter += draws; }
+
+    /**
+     * @brief out[i] = uniform in [0, 1) for i in [0, n)
+     */
+    void uniform(float *out, size_t n);
+
+    /**
+     * @brief out[i] = standard normal sample for i in [0, n)
+     * Box-Muller on the fast pf_math functions, two draws per pair
+     */
+    void gaussian(float *out, size_t n);
+
+    // one 32 bit draw, for scalar code
+    uint32_t next() { return bits(counter++); }
+
+    // 32 bit draw number index of this stream
+    uint32_t bits(uint64_t index) const {
+        return hash(hash(static_cast<uint32_t>(index) + key_lo) ^
+                    static_cast<uint32_t>(index >> 32) ^ key_hi);
+    }
+
+    // a draw as a float in [0, 1), 24 bits of resolution
+    static float to_unit(uint32_t draw) {
+        return static_cast<float>(draw >> 8) * (1.0f / 16777216.0f);
+    }
+
+private:
+    // lowbias32 integer hash (good avalanche, only 32 bit multiplies)
+    static uint32_t hash(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    uint32_t key_lo = 0, key_hi = 0;
+    uint64_t counter = 0;
+};
@@ -1,4 +1,8 @@
 #include "include/pf.hpp"
+#include "include/pf_math.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include "timer.hpp"
 #include <complex>
 #include <iostream>
 #include <algorithm>
@@ -6,18 +10,56 @@
 #include <chrono>
 #include <tuple>
 #include <vector>
-#include <random>
 
-ParticleFilter::ParticleFilter(int num_particles, double x_min, double x_max, double y_min, double y_max) {
-    std::uniform_real_distribution<double> dist_x(x_min, x_max);
-    std::uniform_real_distribution<double> dist_y(y_min, y_max);
-    std::uniform_real_distribution<double> dist_theta(-M_PI, M_PI);
+ParticleFilter::ParticleFilter(int num_particles, double x_min, double x_max, double y_min, double y_max,
+                               uint64_t seed, int num_chunks)
+    : xs(num_particles), ys(num_particles), thetas(num_particles),
+      weights(num_particles, 1.0f / num_particles), rng(seed),
+      noise(3 * num_particles),
+      num_chunks(num_chunks > 0 ? num_chunks : ThreadPool::shared().concurrency()),
+      next_xs(num_particles), next_ys(num_particles), next_thetas(num_particles),
+      inputs(INPUT_CAPACITY) {
+    chunk_rngs.resize(this->num_chunks);
+    for (int chunk = 0; chunk < this->num_chunks; chunk++) {
+        chunk_rngs[chunk].reseed(seed, chunk);
+    }
+    chunk_sums.resize(4 * this->num_chunks);
+    reserve_particles(num_particles);
+    drained.reserve(inputs.capacity() + MAX_PENDING_LOSSES);
+    pending_losses.reserve(MAX_PENDING_LOSSES);
+    pending_timestamps.reserve(MAX_PENDING_LOSSES);
+    filter_stats.particles = num_particles;
+
+    rng.uniform(xs.data(), num_particles);
+    rng.uniform(ys.data(), num_particles);
+    rng.uniform(thetas.data(), num_particles);
 
     for (int i = 0; i < num_particles; ++i) {
-        particles.push_back({dist_x(gen), dist_y(gen), dist_theta(gen), 1.0 / num_particles});
+        xs[i] = x_min + xs[i] * (x_max - x_min);
+        ys[i] = y_min + ys[i] * (y_max - y_min);
+        thetas[i] = -pf_math::PI + thetas[i] * pf_math::TWO_PI;
     }
 }
 
+void ParticleFilter::reinitialize(float x, float y, float theta, float cov_xx, float cov_xy, float cov_yy,
+                                  float std_dev_theta) {
+    const int n = size();
+    rng.gaussian(noise.data(), 3 * n);
+
+    // correlated offsets through the Cholesky factor of the covariance
+    float l_xx = std::sqrt(std::max(cov_xx, 0.0f));
+    float l_yx = l_xx > 0.0f ? cov_xy / l_xx : 0.0f;
+    float l_yy = std::sqrt(std::max(cov_yy - l_yx * l_yx, 0.0f));
+
+    for (int i = 0; i < n; ++i) {
+        float noise_x = noise[i], noise_y = noise[n + i], noise_theta = noise[2 * n + i];
+        xs[i] = x + l_xx * noise_x;
+        ys[i] = y + l_yx * noise_x + l_yy * noise_y;
+        thetas[i] = pf_math::wrap_angle(theta + std_dev_theta * noise_theta);
+    }
+    std::fill(weights.begin(), weights.end(), 1.0f / n);
+}
+
 double ParticleFilter::normalize_angle(double angle){
     while(angle > M_PI){
         angle -= 2*M_PI;
@@ -28,234 +70,474 @@ double ParticleFilter::normalize_angle(double angle){
     return angle;
 }
 
+// * kernels, restrict only holds for parameters, so the loops live here
+
+namespace {
+void move_kernel(int n, float *__restrict xs, float *__restrict ys,
+                 float *__restrict thetas, const float *__restrict noise_x,
+                 const float *__restrict noise_y,
+                 const float *__restrict noise_theta, float x_change,
+                 float y_change, float theta_change, float std_dev_pos,
+                 float std_dev_theta) {
+    for (int i = 0; i < n; i++) {
+        float dx = x_change + noise_x[i] * std_dev_pos;
+        float dy = y_change + noise_y[i] * std_dev_pos;
+
+        // (dx, dy) is in the robot frame: sin(theta + pi/2) = cos(theta),
+        // cos(theta + pi/2) = -sin(theta)
+        float s, c;
+        pf_math::sincos(thetas[i], s, c);
+        xs[i] += dx * c + dy * s;
+        ys[i] += dy * c - dx * s;
+
+        thetas[i] = pf_math::wrap_angle(thetas[i] + theta_change +
+                                        noise_theta[i] * std_dev_theta);
+    }
+}
+
+void weigh_kernel(int n, const float *__restrict xs,
+                  const float *__restrict ys, const float *__restrict thetas,
+                  float *__restrict weights, float meas_x, float meas_y,
+                  float meas_theta, float std_dev_camera) {
+    const float scale = -0.5f / (std_dev_camera * std_dev_camera);
+    for (int i = 0; i < n; i++) {
+        float error_x = meas_x - xs[i];
+        float error_y = meas_y - ys[i];
+        float error_dist = std::sqrt(error_x * error_x + error_y * error_y);
+        float error_theta =
+            std::fabs(pf_math::wrap_angle(meas_theta - thetas[i])) * 1800;
+
+        float distance_sq = 0.5f * error_dist + 0.5f * error_theta;
+        weights[i] *= pf_math::exp(scale * distance_sq);
+    }
+}
+
+void weigh_loss_kernel(int n, const float *__restrict losses,
+                       float *__restrict weights, float std_dev_loss) {
+    const float scale = -0.5f / (std_dev_loss * std_dev_loss);
+    for (int i = 0; i < n; i++) {
+        weights[i] *= pf_math::exp(scale * losses[i] * losses[i]);
+    }
+}
+} // namespace
+
+void ParticleFilter::parallel_chunks(const std::function<void(int)> &fn) {
+    ThreadPool::shared().parallel_for(num_chunks, fn);
+}
+
+void ParticleFilter::move_particles(int chunk, float x_change, float y_change, float theta_change,
+                                    float std_dev_pos, float std_dev_theta) {
+    const int begin = chunk_begin(chunk), count = chunk_begin(chunk + 1) - begin;
+    float *chunk_noise = noise.data() + 3 * begin;
+    chunk_rngs[chunk].gaussian(chunk_noise, 3 * count);
+
+    move_kernel(count, xs.data() + begin, ys.data() + begin, thetas.data() + begin,
+                chunk_noise, chunk_noise + count, chunk_noise + 2 * count,
+                x_change, y_change, theta_change, std_dev_pos, std_dev_theta);
+}
+
+double ParticleFilter::weigh_particles(int chunk, float meas_x, float meas_y, float meas_theta,
+                                       float std_dev_camera) {
+    const int begin = chunk_begin(chunk), end = chunk_begin(chunk + 1);
+    weigh_kernel(end - begin, xs.data() + begin, ys.data() + begin, thetas.data() + begin,
+                 weights.data() + begin, meas_x, meas_y, meas_theta, std_dev_camera);
+
+    double sum_weights = 0.0;
+    for (int i = begin; i < end; i++) {
+        sum_weights += weights[i];
+    }
+    return sum_weights;
+}
+
+double ParticleFilter::weigh_particles_loss(int chunk, const PoseLoss &loss, float std_dev_loss) {
+    const int begin = chunk_begin(chunk), end = chunk_begin(chunk + 1);
+    loss(xs.data() + begin, ys.data() + begin, thetas.data() + begin, end - begin,
+         losses.data() + begin);
+    weigh_loss_kernel(end - begin, losses.data() + begin, weights.data() + begin, std_dev_loss);
+
+    double sum_weights = 0.0;
+    for (int i = begin; i < end; i++) {
+        sum_weights += weights[i];
+    }
+    return sum_weights;
+}
+
 void ParticleFilter::predict(double std_dev_pos, double std_dev_camera, double std_dev_theta) {
-    std::normal_distribution<double> dist_x(0, std_dev_pos);
-    std::normal_distribution<double> dist_y(0, std_dev_pos);
-    std::normal_distribution<double> dist_theta(0, std_dev_theta);
-
-    data_size = theta_changes.size(); // this would work with any other vector too
-    double position_weight = 0.6, orientation_weight = 0.4;
-
-    // for(int i = 0; i < data_size; i++){
-    //     std::cout << "DEBUG: " << i << '\n';
-    //     std::cout << "Camera Position and Theta: " << std::get<0>(position_archive[i]) << " " << std::get<1>(position_archive[i]) << " " << std::get<2>(position_archive[i]) << '\n';
-    //     std::cout << "x_change and y_change: " << std::get<0>(position_changes[i]) + dist_x(gen) << " " << std::get<1>(position_changes[i]) + dist_y(gen) << '\n';
-    //     std::cout << "theta change: " << theta_changes[i] << '\n';
-    // }
-
-    for(int i = 0; i < data_size; i++){
-        double weight_sum = 0.0;
-        double meas_x = std::get<0>(position_archive[i]), meas_y = std::get<1>(position_archive[i]), meas_theta = std::get<2>(position_archive[i]);
-        for(auto& p: particles){
-            double x_change = std::get<0>(position_changes[i]) + dist_x(gen);
-            double y_change = std::get<1>(position_changes[i]) + dist_y(gen);
-            //p.x += x_change;
-            //p.y += y_change;
-            
-            p.x += (x_change)*(std::sin((p.theta + M_PI/2))) + (y_change)*(std::sin(p.theta));
-            p.y += (x_change)*(std::cos((p.theta + M_PI/2))) + (y_change)*(std::cos(p.theta));
-            p.theta += theta_changes[i];
-            //std::cout << theta_changes[i] << '\n';
-            if(meas_x != 10000){
-                double error_x = meas_x - p.x;
-                double error_y = meas_y - p.y;
-                double error_dist = std::sqrt(error_x*error_x + error_y*error_y);
-                double error_theta = normalize_angle(meas_theta - p.theta);
-                error_theta = std::sqrt(error_theta*error_theta)*1800;
-                //std::cout << error_x * error_x << " " << error_y * error_y << " " << error_theta*error_theta*423000 << '\n';
-
-                // double pos_weight = exp(-error_dist * error_dist / (2 * std_dev_camera * std_dev_camera));
-                // double angle_weight = exp((-error_theta * error_theta)/ (2 * std_dev_theta * std_dev_theta));
-        
-                // p.weight = position_weight*pos_weight + angle_weight*orientation_weight;
-                double distance_sq = 0.5*(error_dist) + 0.5*(error_theta);
-                p.weight = exp(-0.5 * distance_sq / (std_dev_camera * std_dev_camera));
-
-                weight_sum += p.weight;
-            }
+    trace::Scope span("pf_predict");
+    const uint64_t start_ns = timer::ns();
+
+    // * drain the inputs, then put them in timestamp order
+    drained.clear();
+    FilterInput input;
+    while (drained.size() < inputs.capacity() && inputs.pop(input)) {
+        drained.push_back(input);
+    }
+    // room is reserved for every pending loss on top of a full ring
+    for (size_t i = 0; i < pending_losses.size(); i++) {
+        drained.push_back(input_at(INPUT_CAMERA_LOSS, pending_timestamps[i], i));
+    }
+
+    // insertion sort, stable and allocation free, the producers' inputs are
+    // each in order already
+    for (size_t i = 1; i < drained.size(); i++) {
+        FilterInput current = drained[i];
+        size_t j = i;
+        for (; j > 0 && drained[j - 1].timestamp_ns > current.timestamp_ns; j--) {
+            drained[j] = drained[j - 1];
+        }
+        drained[j] = current;
+    }
+
+    // * integrate the motion between camera inputs, in the robot frame of the
+    // previous one, then move and weigh once per camera input
+    float x_change = 0.0f, y_change = 0.0f, theta_change = 0.0f;
+    bool moved = false;
+
+    for (const FilterInput &event : drained) {
+        if (event.kind == INPUT_ODOMETRY) {
+            float s, c;
+            pf_math::sincos(theta_change, s, c);
+            // rotated by the turn so far, the same way move_kernel turns
+            // robot frame changes into field ones
+            x_change += event.a * c + event.b * s;
+            y_change += event.b * c - event.a * s;
+            moved = true;
+            continue;
+        }
+        if (event.kind == INPUT_IMU) {
+            theta_change += event.a;
+            moved = true;
+            continue;
+        }
+
+        if (event.timestamp_ns < last_measurement_ns) {
+            late++;
+        }
+        last_measurement_ns = std::max(last_measurement_ns, event.timestamp_ns);
+
+        const PoseLoss *loss = nullptr;
+        float std_dev_loss = 0.0f;
+        if (event.kind == INPUT_CAMERA_LOSS) {
+            loss = &std::get<0>(pending_losses[(size_t)event.a]);
+            std_dev_loss = std::get<1>(pending_losses[(size_t)event.a]);
         }
 
-        if(meas_x != 10000){
-            normalize_weights();
+        // move and weigh each chunk in one pass, then combine the chunk sums
+        // (in chunk order, so the result does not depend on scheduling)
+        for_each_chunk([&](int chunk) {
+            move_particles(chunk, x_change, y_change, theta_change, std_dev_pos, std_dev_theta);
+            if (loss) {
+                chunk_sums[4 * chunk] = weigh_particles_loss(chunk, *loss, std_dev_loss);
+            } else {
+                chunk_sums[4 * chunk] = weigh_particles(chunk, event.a, event.b, event.c, std_dev_camera);
+            }
+        });
+
+        double sum_weights = 0.0;
+        for (int chunk = 0; chunk < num_chunks; chunk++) {
+            sum_weights += chunk_sums[4 * chunk];
         }
+        scale_weights(sum_weights);
+
+        x_change = y_change = theta_change = 0.0f;
+        moved = false;
+    }
+
+    // motion after the last camera input
+    if (moved) {
+        for_each_chunk([&](int chunk) {
+            move_particles(chunk, x_change, y_change, theta_change, std_dev_pos, std_dev_theta);
+        });
     }
-    theta_changes.clear();
-    position_changes.clear();
-    position_archive.clear();
+
+    pending_losses.clear();
+    pending_timestamps.clear();
+
+    filter_stats.predict_ns = timer::ns() - start_ns;
+}
+
+FilterInput ParticleFilter::input_at(FilterInputKind kind, uint64_t timestamp_ns, float a, float b, float c) {
+    FilterInput input;
+    input.timestamp_ns = timestamp_ns;
+    input.kind = kind;
+    input.a = a;
+    input.b = b;
+    input.c = c;
+    return input;
 }
 
-void ParticleFilter::check_added_new_input(){
-    if(not added_new_input){
-        added_new_input = true;
-        position_changes.push_back(std::make_tuple(0.0, 0.0));
-        position_archive.push_back(std::make_tuple(10000, 10000, 10000));
-        theta_changes.push_back(0.0);
+bool ParticleFilter::push_input(const FilterInput &input) {
+    if (!inputs.push(input)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
+    return true;
 }
 
-void ParticleFilter::update_mouse(std::tuple<double, double> delta_position){
-    check_added_new_input();
+bool ParticleFilter::push_odometry(float x_change, float y_change, uint64_t timestamp_ns) {
+    return push_input(input_at(INPUT_ODOMETRY, timestamp_ns, x_change, y_change));
+}
 
-    position_changes[position_changes.size() - 1]  = delta_position;
+bool ParticleFilter::push_imu(float theta_change, uint64_t timestamp_ns) {
+    return push_input(input_at(INPUT_IMU, timestamp_ns, theta_change));
 }
 
-void ParticleFilter::update_imu(double delta_theta){
-    check_added_new_input();
+bool ParticleFilter::push_camera(float x, float y, float theta, uint64_t timestamp_ns) {
+    return push_input(input_at(INPUT_CAMERA_POSE, timestamp_ns, x, y, theta));
+}
 
-    theta_changes[theta_changes.size() - 1] = delta_theta;
+void ParticleFilter::update_mouse(std::tuple<double, double> delta_position){
+    push_odometry(std::get<0>(delta_position), std::get<1>(delta_position));
 }
 
-void ParticleFilter::update_camera(std::tuple<double, double, double> new_position){
+void ParticleFilter::update_imu(double delta_theta){
+    push_imu(delta_theta);
+}
 
-    check_added_new_input();
+void ParticleFilter::update_camera(std::tuple<double, double, double> new_position){
+    push_camera(std::get<0>(new_position), std::get<1>(new_position), std::get<2>(new_position));
+}
 
-    position_archive[position_archive.size() - 1] = new_position;
+void ParticleFilter::update_camera_loss(PoseLoss loss, double std_dev_loss, uint64_t timestamp_ns){
+    if (pending_losses.size() >= MAX_PENDING_LOSSES) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    pending_losses.push_back(std::make_tuple(std::move(loss), std_dev_loss));
+    pending_timestamps.push_back(timestamp_ns);
 }
 
 
 void ParticleFilter::normalize_weights() {
+    for_each_chunk([&](int chunk) {
+        double sum_weights = 0.0;
+        for (int i = chunk_begin(chunk); i < chunk_begin(chunk + 1); i++) {
+            sum_weights += weights[i];
+        }
+        chunk_sums[4 * chunk] = sum_weights;
+    });
+
     double sum_weights = 0.0;
-    for (const auto& p : particles) {
-        sum_weights += p.weight;
+    for (int chunk = 0; chunk < num_chunks; chunk++) {
+        sum_weights += chunk_sums[4 * chunk];
+    }
+    scale_weights(sum_weights);
+}
+
+// a single vectorized pass, cheaper than another round trip to the pool
+void ParticleFilter::scale_weights(double sum_weights) {
+    if (!(sum_weights > 0.0)) {
+        // every particle underflowed, nothing to prefer
+        std::fill(weights.begin(), weights.end(), 1.0f / size());
+        return;
     }
-    for (auto& p : particles) {
-        p.weight /= sum_weights;
+    const float inv_sum = 1.0 / sum_weights;
+    for (float &weight : weights) {
+        weight *= inv_sum;
     }
 }
 
 // Function to compute entropy of particle weights
 double ParticleFilter::calculate_entropy() {
     double entropy = 0.0;
-    for (const auto& p : particles) {
-        if (p.weight > 0) {
-            entropy += p.weight * std::log2(p.weight);
+    for (float weight : weights) {
+        if (weight > 0) {
+            entropy += weight * std::log2(weight);
         }
     }
     return -entropy;
 }
 
 
-// ------------------ LOW ENTROPY: CDF Resampling ------------------
-std::vector<double> ParticleFilter::build_cdf() {
-    std::vector<double> cdf(particles.size());
-    cdf[0] = particles[0].weight;
-    for (size_t i = 1; i < particles.size(); ++i) {
-        cdf[i] = cdf[i - 1] + particles[i].weight;
+double ParticleFilter::effective_sample_size() {
+    normalize_weights();
+
+    double sum_squares = 0.0;
+    for (float weight : weights) {
+        sum_squares += weight * weight;
     }
-    return cdf;
+    return 1.0 / sum_squares;
 }
 
-int ParticleFilter::sample_cdf(const std::vector<double>& cdf, std::mt19937& rng) {
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-    double rand_val = dist(rng);
-    return lower_bound(cdf.begin(), cdf.end(), rand_val) - cdf.begin();
-}
+bool ParticleFilter::resample_particles(ResampleScheme scheme, double min_effective_fraction) {
+    const int n = size();
+    if (effective_sample_size() >= min_effective_fraction * n) {
+        return false;
+    }
 
-// ------------------ HIGH ENTROPY: Alias Method ------------------
+    trace::Scope span("pf_resample");
+    const uint64_t start_ns = timer::ns();
 
-void ParticleFilter::build_alias_table() {
-    int n = particles.size();
-    std::vector<double> scaled_probs(n);
-    std::vector<int> small, large;
+    int n_out = n;
+    if (kld_enabled) {
+        filter_stats.occupied_bins = count_occupied_bins();
+        n_out = kld_particle_count(filter_stats.occupied_bins);
+    }
 
-    for (int i = 0; i < n; ++i) {
-        scaled_probs[i] = particles[i].weight * n;
-        if (scaled_probs[i] < 1.0) small.push_back(i);
-        else large.push_back(i);
+    // pointer i sits at (i + u_i) / N, u_i in [0, 1), so one sweep over the
+    // running weight sum finds every pick
+    float *offsets = noise.data();
+    if (scheme == RESAMPLE_STRATIFIED) {
+        rng.uniform(offsets, n_out);
+    } else {
+        rng.uniform(offsets, 1);
+        std::fill(offsets + 1, offsets + n_out, offsets[0]);
     }
 
-    prob.resize(n);
-    alias.resize(n);
+    next_xs.resize(n_out);
+    next_ys.resize(n_out);
+    next_thetas.resize(n_out);
+
+    const double step = 1.0 / n_out;
+    double cumulative = weights[0];
+    int picked = 0;
+    for (int i = 0; i < n_out; ++i) {
+        double pointer = (i + offsets[i]) * step;
+        while (pointer > cumulative && picked < n - 1) {
+            cumulative += weights[++picked];
+        }
+        next_xs[i] = xs[picked];
+        next_ys[i] = ys[picked];
+        next_thetas[i] = thetas[picked];
+    }
 
-    while (!small.empty() && !large.empty()) {
-        int small_idx = small.back(); small.pop_back();
-        int large_idx = large.back();
+    std::swap(xs, next_xs);
+    std::swap(ys, next_ys);
+    std::swap(thetas, next_thetas);
+    weights.assign(n_out, 1.0f / n_out);
 
-        prob[small_idx] = scaled_probs[small_idx];
-        alias[small_idx] = large_idx;
+    filter_stats.particles = n_out;
+    filter_stats.resample_ns = timer::ns() - start_ns;
+    return true;
+}
 
-        scaled_probs[large_idx] -= (1.0 - scaled_probs[small_idx]);
-        if (scaled_probs[large_idx] < 1.0) {
-            small.push_back(large_idx);
-            large.pop_back();
-        }
+void ParticleFilter::set_kld(const KldConfig &config) {
+    kld = config;
+    kld.min_particles = std::max(1, kld.min_particles);
+    kld.max_particles = std::max(kld.min_particles, kld.max_particles);
+    kld_enabled = true;
+
+    reserve_particles(kld.max_particles);
+}
+
+void ParticleFilter::reserve_particles(int capacity) {
+    capacity = std::max(capacity, size());
+    for (std::vector<float> *field : {&xs, &ys, &thetas, &weights, &next_xs, &next_ys, &next_thetas}) {
+        field->reserve(capacity);
+    }
+    if ((int)losses.size() < capacity) {
+        losses.resize(capacity);
+    }
+    if ((int)noise.size() < 3 * capacity) {
+        noise.resize(3 * capacity);
     }
 
-    while (!large.empty()) {
-        prob[large.back()] = 1.0;
-        large.pop_back();
+    // at most half full
+    size_t bin_capacity = 1;
+    while (bin_capacity < 2 * (size_t)capacity) {
+        bin_capacity <<= 1;
     }
-    while (!small.empty()) {
-        prob[small.back()] = 1.0;
-        small.pop_back();
+    if (bins.size() < bin_capacity) {
+        bins.assign(bin_capacity, 0);
+        bin_stamp = 0;
     }
 }
 
-int ParticleFilter::sample_alias(std::mt19937& rng) {
-    std::uniform_int_distribution<int> int_dist(0, prob.size() - 1);
-    std::uniform_real_distribution<double> real_dist(0.0, 1.0);
-
-    int idx = int_dist(rng);
-    return (real_dist(rng) < prob[idx]) ? idx : alias[idx];
-}
+int ParticleFilter::count_occupied_bins() {
+    const int n = size();
+    const double pointers = kld.max_particles;
+    const uint64_t mask = bins.size() - 1;
+    const float inv_bin_xy = 1.0f / kld.bin_xy, inv_bin_theta = 1.0f / kld.bin_theta;
 
-void ParticleFilter::resample_particles(std::mt19937& rng){
-    int n = particles.size();
-    normalize_weights();
+    // a new stamp empties the set without touching it
+    if (++bin_stamp == 0) {
+        std::fill(bins.begin(), bins.end(), 0);
+        bin_stamp = 1;
+    }
 
-    // Compute entropy
-    double entropy = calculate_entropy();
-    double threshold = log2(n);
+    // a particle is picked if a pointer (spacing 1 / max_particles) falls in
+    // its slice of the running weight sum, rounding the pointer offset to 1/2
+    int occupied = 0;
+    double cumulative = 0.0;
+    for (int i = 0; i < n; i++) {
+        double before = cumulative;
+        cumulative += weights[i];
+        if (std::floor(cumulative * pointers + 0.5) == std::floor(before * pointers + 0.5)) {
+            continue;
+        }
 
-    std::vector<Particle> new_particles(n);
+        // 11 bits per position, 10 for the heading
+        uint32_t bin_x = (uint32_t)((int32_t)std::floor(xs[i] * inv_bin_xy) + 1024) & 0x7ff;
+        uint32_t bin_y = (uint32_t)((int32_t)std::floor(ys[i] * inv_bin_xy) + 1024) & 0x7ff;
+        uint32_t bin_theta = (uint32_t)std::floor((thetas[i] + pf_math::PI) * inv_bin_theta) & 0x3ff;
+        uint32_t key = bin_x | bin_y << 11 | bin_theta << 22;
 
-    if (entropy < 0.5 * threshold) {
-        // Low entropy → Use CDF-based binary search
-        std::vector<double> cdf = build_cdf();
-        std::cout << "Using CDF Resampling (Low Entropy)" << "Entropy: " << entropy << '\n';
-        for (int i = 0; i < n; ++i) {
-            int idx = sample_cdf(cdf, rng);
-            new_particles[i] = particles[idx];
+        uint64_t entry = (uint64_t)bin_stamp << 32 | key;
+        uint64_t slot = (key * 0x9e3779b1u) & mask;
+        while (bins[slot] >> 32 == bin_stamp && bins[slot] != entry) {
+            slot = (slot + 1) & mask;
         }
-    } else {
-        // High entropy → Use Alias Method
-        build_alias_table();
-        std::cout << "Using Alias Method Resampling (High Entropy)" << "Entropy: " << entropy << '\n';
-        for (int i = 0; i < n; ++i) {
-            int idx = sample_alias(rng);
-            new_particles[i] = particles[idx];
+        if (bins[slot] != entry) {
+            bins[slot] = entry;
+            occupied++;
         }
     }
+    return occupied;
+}
 
-    // Reset weights after resampling
-    for (auto& p : new_particles) {
-        p.weight = 1.0 / n;
+int ParticleFilter::kld_particle_count(int occupied_bins) const {
+    if (occupied_bins <= 1) {
+        return kld.min_particles;
     }
 
-    std::swap(particles, new_particles);
-    
+    // Wilson-Hilferty approximation of the chi-square quantile, Fox 2003
+    double k = occupied_bins - 1;
+    double a = 2.0 / (9.0 * k);
+    double term = 1.0 - a + std::sqrt(a) * kld.z;
+    double count = k / (2.0 * kld.epsilon) * term * term * term;
+
+    return (int)std::min<double>(std::max<double>(std::ceil(count), kld.min_particles),
+                                 kld.max_particles);
 }
 
 void ParticleFilter::printParticles() const {
-    for (const auto& p : particles) {
-        std::cout << "Particle at: (" << p.x << ", " << p.y << ") θ: " << p.theta 
-                  << " Weight: " << p.weight << '\n';
+    for (int i = 0; i < size(); ++i) {
+        std::cout << "Particle at: (" << xs[i] << ", " << ys[i] << ") θ: " << thetas[i] 
+                  << " Weight: " << weights[i] << '\n';
     }
     std::cout << "----------------\n";
 }
 
 Particle ParticleFilter::estimate_position(){
-    double x_est = 0.0, y_est = 0.0, sin_theta = 0.0, cos_theta = 0.0;
+    // weighted mean position and heading vector per chunk, then combined
+    for_each_chunk([&](int chunk) {
+        double x_est = 0.0, y_est = 0.0, sin_theta = 0.0, cos_theta = 0.0;
+        for (int i = chunk_begin(chunk); i < chunk_begin(chunk + 1); i++) {
+            float s, c;
+            pf_math::sincos(thetas[i], s, c);
+            x_est += xs[i] * weights[i];
+            y_est += ys[i] * weights[i];
+            sin_theta += s * weights[i];
+            cos_theta += c * weights[i];
+        }
 
-    for(const auto& p: particles){
-        x_est += p.x * p.weight;
-        y_est += p.y * p.weight;
-        sin_theta += std::sin(p.theta)*p.weight;
-        cos_theta +=  std::cos(p.theta)*p.weight;
+        double *sums = &chunk_sums[4 * chunk];
+        sums[0] = x_est;
+        sums[1] = y_est;
+        sums[2] = sin_theta;
+        sums[3] = cos_theta;
+    });
+
+    double x_est = 0.0, y_est = 0.0, sin_theta = 0.0, cos_theta = 0.0;
+    for (int chunk = 0; chunk < num_chunks; chunk++) {
+        const double *sums = &chunk_sums[4 * chunk];
+        x_est += sums[0];
+        y_est += sums[1];
+        sin_theta += sums[2];
+        cos_theta += sums[3];
     }
 
     double theta_est = normalize_angle(std::atan2(sin_theta, cos_theta));
 
-    return {x_est, y_est, theta_est, 1.0};
+    return {(float)x_est, (float)y_est, (float)theta_est, 1.0f};
 }
-
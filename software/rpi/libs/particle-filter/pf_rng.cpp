@@ -0,0 +1,38 @@
+#include "include/pf_rng.hpp"
+#include "include/pf_math.hpp"
+#include <cmath>
+
+void CounterRng::uniform(float *out, size_t n) {
+    const uint64_t start = counter;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = to_unit(bits(start + i));
+    }
+    counter += n;
+}
+
+void CounterRng::gaussian(float *out, size_t n) {
+    const uint64_t start = counter;
+    const size_t pairs = n / 2;
+
+    for (size_t i = 0; i < pairs; i++) {
+        // u1 in (0, 1] so the log is finite
+        float u1 = to_unit(bits(start + 2 * i)) + (1.0f / 16777216.0f);
+        float u2 = to_unit(bits(start + 2 * i + 1));
+
+        float radius = std::sqrt(-2.0f * pf_math::log(u1));
+        float s, c;
+        pf_math::sincos(pf_math::TWO_PI * u2, s, c);
+        out[2 * i]     = radius * c;
+        out[2 * i + 1] = radius * s;
+    }
+
+    if (n & 1) {
+        float u1 = to_unit(bits(start + 2 * pairs)) + (1.0f / 16777216.0f);
+        float u2 = to_unit(bits(start + 2 * pairs + 1));
+        float s, c;
+        pf_math::sincos(pf_math::TWO_PI * u2, s, c);
+        out[n - 1] = std::sqrt(-2.0f * pf_math::log(u1)) * c;
+    }
+
+    counter += 2 * ((n + 1) / 2);
+}
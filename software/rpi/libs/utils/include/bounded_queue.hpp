@@ -0,0 +1,103 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed capacity FIFO between threads that never blocks the producer
+ * Pushing into a full queue drops the oldest item, so a slow consumer always
+ * works on the freshest data. Storage is allocated once, up front.
+ */
+template <typename T> class BoundedQueue {
+  public:
+    explicit BoundedQueue(size_t capacity)
+        : _items(capacity > 0 ? capacity : 1) {}
+
+    BoundedQueue(const BoundedQueue &)            = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /**
+     * @brief Add an item, dropping the oldest one if full
+     * @return false if an item was dropped
+     */
+    bool push(T item) {
+        T dropped;
+        bool kept = true;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_count == _items.size()) {
+                // destroyed outside of the lock
+                dropped = std::move(_items[_head]);
+                _head   = (_head + 1) % _items.size();
+                _count--;
+                kept = false;
+            }
+            _items[(_head + _count) % _items.size()] = std::move(item);
+            _count++;
+        }
+        _cv.notify_one();
+        return kept;
+    }
+
+    /**
+     * @brief Wait for an item
+     * @return false once the queue is closed and empty
+     */
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this] { return _count > 0 || _closed; });
+        if (_count == 0) {
+            return false;
+        }
+
+        item  = std::move(_items[_head]);
+        _head = (_head + 1) % _items.size();
+        _count--;
+        return true;
+    }
+
+    /**
+     * @brief Wake every waiter, pop fails once the queue drains
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _cv.notify_all();
+    }
+
+    /**
+     * @brief Drop every item and reopen the queue
+     */
+    void reset() {
+        std::vector<T> dropped;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            dropped.resize(_items.size());
+            for (size_t i = 0; i < _items.size(); i++) {
+                std::swap(dropped[i], _items[i]);
+            }
+            _head   = 0;
+            _count  = 0;
+            _closed = false;
+        }
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _count;
+    }
+
+  private:
+    std::vector<T> _items;
+    size_t _head  = 0;
+    size_t _count = 0;
+    bool _closed  = false;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+};
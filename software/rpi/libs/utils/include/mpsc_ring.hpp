@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Fixed capacity, lock-free FIFO from many producer threads to one
+ * consumer thread
+ * Each slot carries a sequence number saying whose turn it is (bounded MPMC
+ * queue by D. Vyukov, with the consumer side simplified), so producers only
+ * contend on one atomic and never wait on each other. Storage is allocated
+ * once, up front, and pushing into a full ring fails instead of blocking.
+ * ^ T is copied in and out, keep it small and trivially copyable
+ */
+template <typename T> class MpscRing {
+  public:
+    /**
+     * @param capacity Rounded up to a power of two
+     */
+    explicit MpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        _slots = std::make_unique<Slot[]>(size);
+        _mask  = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing &)            = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+
+    /**
+     * @brief Add an item, from any thread
+     * @return false if the ring is full (the item is dropped)
+     */
+    bool push(const T &item) {
+        uint64_t position = _head.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot              = &_slots[position & _mask];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int64_t lag       = (int64_t)(sequence - position);
+
+            if (lag == 0) {
+                // the slot is free for this position, claim it
+                if (_head.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                // the consumer has not freed it yet
+                return false;
+            } else {
+                position = _head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = item;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item, only from the consumer thread
+     * @return false if the ring is empty
+     */
+    bool pop(T &item) {
+        Slot *slot = &_slots[_tail & _mask];
+        if (slot->sequence.load(std::memory_order_acquire) != _tail + 1) {
+            return false;
+        }
+
+        item = slot->value;
+        slot->sequence.store(_tail + _mask + 1, std::memory_order_release);
+        _tail++;
+        return true;
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    size_t _mask;
+
+    // producers and the consumer on separate cache lines
+    alignas(64) std::atomic<uint64_t> _head{0};
+    alignas(64) uint64_t _tail = 0;
+};
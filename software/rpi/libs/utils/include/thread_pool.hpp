@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads for splitting a loop across cores
+ * The calling thread takes part in the work, so a pool of N threads keeps
+ * N + 1 cores busy. Only one parallel_for runs at a time per pool.
+ */
+class ThreadPool {
+  public:
+    /**
+     * @param num_threads Worker threads to spawn, on top of the caller
+     */
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Number of threads working on a parallel_for, including the caller
+     */
+    int concurrency() const { return (int)_workers.size() + 1; }
+
+    /**
+     * @brief Run fn(chunk) for every chunk in [0, num_chunks), blocking until
+     * all chunks are done. Chunks are handed out dynamically, so uneven chunks
+     * still balance.
+     */
+    void parallel_for(int num_chunks, const std::function<void(int)> &fn);
+
+    /**
+     * @brief Pool shared by the whole process, one worker per extra core
+     */
+    static ThreadPool &shared();
+
+  private:
+    void worker_loop();
+    void run_chunks();
+
+    std::vector<std::thread> _workers;
+
+    // serializes parallel_for callers
+    std::mutex _call_mutex;
+
+    std::mutex _mutex;
+    std::condition_variable _work_cv;
+    std::condition_variable _done_cv;
+    bool _stopping    = false;
+    uint64_t _job_id  = 0;
+    int _busy_workers = 0;
+
+    // current job
+    const std::function<void(int)> *_fn = nullptr;
+    int _num_chunks                     = 0;
+    std::atomic<int> _next_chunk{0};
+};
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "types.hpp"
 #include <time.h>
 
@@ -9,4 +11,14 @@ inline types::u64 us(void) {
     types::u64 time_us = ts.tv_sec * 1e6 + (float)ts.tv_nsec * 1e-3;
     return time_us;
 }
+
+/**
+ * @brief Nanoseconds on the same clock as libcamera's SensorTimestamp
+ * (CLOCK_BOOTTIME), so frame ages can be taken directly. Thread safe.
+ */
+inline types::u64 ns(void) {
+    timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    return (types::u64)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
 } // namespace timer
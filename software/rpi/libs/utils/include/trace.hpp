@@ -0,0 +1,80 @@
+#pragma once
+
+#include "timer.hpp"
+#include "types.hpp"
+#include <cstdio>
+#include <vector>
+
+/**
+ * @brief Latency tracing, from sensor timestamps to motor commands
+ * Spans are recorded into a fixed, lock-free ring (the oldest spans are
+ * overwritten), so recording is cheap enough to leave on in matches. All
+ * times are timer::ns(), the clock of libcamera's SensorTimestamp.
+ * ^ Span names are stored as pointers, only pass string literals
+ */
+namespace trace {
+
+// spans kept, a power of two
+constexpr types::u32 RING_SIZE = 1 << 14;
+
+struct Span {
+    const char *name;
+    types::u64 start_ns;
+    types::u64 end_ns;
+    types::u64 id; // frame id, packet identifier, ... (0 if none)
+    types::u32 thread;
+};
+
+/**
+ * @brief Record a finished span, never blocks
+ */
+void record(const char *name, types::u64 start_ns, types::u64 end_ns,
+            types::u64 id = 0);
+
+/**
+ * @brief Records the span from construction to destruction
+ */
+class Scope {
+  public:
+    explicit Scope(const char *name, types::u64 id = 0)
+        : _name(name), _id(id), _start_ns(timer::ns()) {}
+    ~Scope() { record(_name, _start_ns, timer::ns(), _id); }
+
+    Scope(const Scope &)            = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    const char *_name;
+    types::u64 _id;
+    types::u64 _start_ns;
+};
+
+/**
+ * @brief Sensor timestamp of the newest observation acted on, set by the
+ * vision publisher, so actuation can record how old its input is
+ */
+void set_observation(types::u64 sensor_ns);
+types::u64 observation();
+
+/**
+ * @brief Copy of the spans currently in the ring, oldest first
+ */
+std::vector<Span> snapshot();
+
+/**
+ * @brief Drop every recorded span
+ */
+void clear();
+
+/**
+ * @brief Write the ring as Chrome / Perfetto trace JSON
+ * (load it in chrome://tracing or ui.perfetto.dev)
+ */
+bool dump_chrome_json(const char *path);
+
+/**
+ * @brief Print p50 / p99 / max duration of every span name
+ */
+void print_histograms(FILE *out = stdout);
+
+} // namespace trace
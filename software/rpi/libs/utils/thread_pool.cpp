@@ -0,0 +1,85 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int num_threads) {
+    for (int i = 0; i < num_threads; i++) {
+        _workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _work_cv.notify_all();
+
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallel_for(int num_chunks,
+                              const std::function<void(int)> &fn) {
+    if (num_chunks <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> call_lock(_call_mutex);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _fn         = &fn;
+        _num_chunks = num_chunks;
+        _next_chunk.store(0, std::memory_order_relaxed);
+        _busy_workers = (int)_workers.size();
+        _job_id++;
+    }
+    _work_cv.notify_all();
+
+    // the caller works too
+    run_chunks();
+
+    // wait for the workers to drop the job, so fn can go out of scope
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done_cv.wait(lock, [this] { return _busy_workers == 0; });
+    _fn = nullptr;
+}
+
+void ThreadPool::run_chunks() {
+    int chunk;
+    while ((chunk = _next_chunk.fetch_add(1, std::memory_order_relaxed)) <
+           _num_chunks) {
+        (*_fn)(chunk);
+    }
+}
+
+void ThreadPool::worker_loop() {
+    uint64_t seen_job = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_cv.wait(lock,
+                          [&] { return _stopping || _job_id != seen_job; });
+            if (_stopping) {
+                return;
+            }
+            seen_job = _job_id;
+        }
+
+        run_chunks();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _busy_workers--;
+        }
+        _done_cv.notify_one();
+    }
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool(
+        std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
@@ -0,0 +1,124 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <string>
+
+namespace trace {
+
+namespace {
+// each slot is a tiny seqlock: odd while being written, then 2 * (index + 1)
+// once span index is complete, so readers can skip torn or stale slots
+struct Slot {
+    std::atomic<types::u64> seq{0};
+    Span span;
+};
+
+Slot ring[RING_SIZE];
+std::atomic<types::u64> head{0};
+std::atomic<types::u64> first{0}; // index of the oldest span kept by clear
+
+std::atomic<types::u64> last_observation{0};
+
+std::atomic<types::u32> next_thread{0};
+thread_local types::u32 thread_index = next_thread.fetch_add(1);
+} // namespace
+
+void record(const char *name, types::u64 start_ns, types::u64 end_ns,
+            types::u64 id) {
+    types::u64 index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot       = ring[index & (RING_SIZE - 1)];
+
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.span.name     = name;
+    slot.span.start_ns = start_ns;
+    slot.span.end_ns   = end_ns;
+    slot.span.id       = id;
+    slot.span.thread   = thread_index;
+
+    slot.seq.store(2 * (index + 1), std::memory_order_release);
+}
+
+void set_observation(types::u64 sensor_ns) {
+    last_observation.store(sensor_ns, std::memory_order_relaxed);
+}
+
+types::u64 observation() {
+    return last_observation.load(std::memory_order_relaxed);
+}
+
+std::vector<Span> snapshot() {
+    types::u64 end   = head.load(std::memory_order_acquire);
+    types::u64 begin = std::max(first.load(std::memory_order_relaxed),
+                                end > RING_SIZE ? end - RING_SIZE : 0);
+
+    std::vector<Span> spans;
+    spans.reserve(end - begin);
+    for (types::u64 index = begin; index < end; index++) {
+        Slot &slot = ring[index & (RING_SIZE - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != 2 * (index + 1)) {
+            continue; // still being written, or already overwritten
+        }
+
+        Span span;
+        std::memcpy(&span, &slot.span, sizeof(span));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == 2 * (index + 1)) {
+            spans.push_back(span);
+        }
+    }
+    return spans;
+}
+
+void clear() {
+    first.store(head.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+}
+
+bool dump_chrome_json(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    std::vector<Span> spans = snapshot();
+
+    // complete ("X") events, times in microseconds
+    fprintf(file, "{\"traceEvents\":[");
+    for (size_t i = 0; i < spans.size(); i++) {
+        const Span &span = spans[i];
+        fprintf(file,
+                "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+                "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":%llu}}",
+                i ? "," : "", span.name, span.thread, span.start_ns / 1e3,
+                (span.end_ns - span.start_ns) / 1e3,
+                (unsigned long long)span.id);
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    return fclose(file) == 0;
+}
+
+void print_histograms(FILE *out) {
+    std::map<std::string, std::vector<types::u64>> durations;
+    for (const Span &span : snapshot()) {
+        durations[span.name].push_back(span.end_ns - span.start_ns);
+    }
+
+    fprintf(out, "%-24s %8s %10s %10s %10s\n", "span", "count", "p50 (us)",
+            "p99 (us)", "max (us)");
+    for (auto &entry : durations) {
+        std::vector<types::u64> &values = entry.second;
+        std::sort(values.begin(), values.end());
+
+        fprintf(out, "%-24s %8zu %10.1f %10.1f %10.1f\n", entry.first.c_str(),
+                values.size(), values[values.size() / 2] / 1e3,
+                values[values.size() * 99 / 100] / 1e3, values.back() / 1e3);
+    }
+}
+
+} // namespace trace
@@ -40,14 +40,8 @@ bool start() {
     // }
 
     // ^ Motion Control
-    motors::command_motor(1, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    motors::command_motor(2, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    motors::command_motor(3, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    motors::command_motor(4, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    const types::i16 stopped[4] = {0, 0, 0, 0};
+    motors::command_all_motors_motion_controller(stopped);
 
     debug::info("INITIALIZED MOTION CONTROL - SUCCESS");
 
@@ -74,14 +68,8 @@ void stop() {
     debug::warn("STOPPING MOTION...\n");
     // motion_controller.stopControlThread();
 
-    motors::command_motor(1, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    motors::command_motor(2, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    motors::command_motor(3, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    motors::command_motor(4, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    const types::i16 stopped[4] = {0, 0, 0, 0};
+    motors::command_all_motors_motion_controller(stopped);
 
     // ^ Stop Camera
     debug::warn("STOPPING CAMERA...");
@@ -70,4 +70,18 @@ int main(int argc, char **argv) {
                     end_time - start_time).count();
 
     std::cout << "Duration: " << duration << " ms" << std::endl;
+
+    // distance map: built once, then reused for every guess
+    start_time = std::chrono::high_resolution_clock::now();
+
+    cv::Mat distance_map = processor.build_distance_map(test_frame);
+    for (int i = 0; i < n_iter; i++) {
+        processor.calculate_loss_distance(distance_map, positions[i]);
+    }
+
+    end_time = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                   end_time - start_time).count();
+
+    std::cout << "Duration (distance map): " << duration << " ms" << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "processor.hpp"
+#include "replay_camera.hpp"
+#include "trace.hpp"
+#include "vision_pipeline.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Replays a recording through the vision pipeline, no camera needed
+// usage: camera_replay [video or .raw dump] [--fast] [--serial]
+//   --fast    every frame, as fast as possible (default: recorded rate)
+//   --serial  CamProcessor::process_frame instead of the VisionPipeline
+int main(int argc, char **argv) {
+    std::string path = "./480p.mp4";
+    bool fast        = false;
+    bool serial      = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fast") == 0) {
+            fast = true;
+        } else if (strcmp(argv[i], "--serial") == 0) {
+            serial = true;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    camera::ReplayCamera cam(path, fast ? camera::REPLAY_FAST
+                                        : camera::REPLAY_RECORDED_RATE);
+    if (!cam.initialize(camera::RES_480P)) {
+        fprintf(stderr, "Failed to open %s\n", path.c_str());
+        return 1;
+    }
+
+    camera::VisionPipeline pipeline;
+
+    auto start = std::chrono::steady_clock::now();
+    bool started;
+    if (serial) {
+        started = cam.startCapture(camera::CamProcessor::process_frame);
+    } else {
+        pipeline.start();
+        started = cam.startStreaming([&](camera::FrameHandle frame) {
+            pipeline.submit(std::move(frame));
+        });
+    }
+    if (!started) {
+        fprintf(stderr, "Failed to start replay\n");
+        return 1;
+    }
+
+    cam.waitForEnd();
+    pipeline.stop();
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    printf("Frames: %llu in %.2f s (%.1f fps)\n",
+           (unsigned long long)cam.framesRead(), seconds,
+           cam.framesRead() / seconds);
+    printf("Camera frames overwritten: %llu, skipped: %llu\n",
+           (unsigned long long)cam.overwrittenFrames(),
+           (unsigned long long)cam.skippedFrames());
+    if (!serial) {
+        printf("Pipeline published: %llu, dropped: %llu\n",
+               (unsigned long long)pipeline.published(),
+               (unsigned long long)pipeline.dropped());
+    }
+
+    trace::print_histograms();
+    return 0;
+}
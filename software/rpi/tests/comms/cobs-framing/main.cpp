@@ -0,0 +1,93 @@
+#include "comms/cobs.hpp"
+#include "comms/rx_ring.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace types;
+
+const int N_PACKETS = 20000;
+
+int main() {
+    std::mt19937 rng(0);
+    int failures = 0;
+
+    // CRC-16/CCITT-FALSE check value
+    u16 check = comms::cobs::crc16((const u8 *)"123456789", 9);
+    printf("crc16(\"123456789\") = 0x%04x (expected 0x29b1)\n", check);
+    failures += check != 0x29b1;
+
+    // * encode random packets (many zeros, some over 254 bytes) into one
+    // stream, corrupting every 10th frame by one bit
+    std::vector<std::vector<u8>> packets;
+    std::vector<bool> corrupted;
+    std::vector<u8> stream;
+    for (int i = 0; i < N_PACKETS; i++) {
+        std::vector<u8> packet(1 + rng() % 600);
+        for (u8 &byte : packet) {
+            byte = rng() % 3 == 0 ? 0 : rng();
+        }
+
+        std::vector<u8> frame(comms::cobs::max_frame_size(packet.size()));
+        comms::cobs::Encoder encoder(frame.data());
+        encoder.write(packet[0]);
+        encoder.write(packet.data() + 1, packet.size() - 1);
+        frame.resize(encoder.finish());
+
+        // flip a bit of a frame byte, never into a (delimiter) zero
+        bool corrupt = i % 10 == 0;
+        if (corrupt) {
+            u8 &byte = frame[rng() % (frame.size() - 1)];
+            u8 flipped;
+            do {
+                flipped = byte ^ (1 << (rng() % 8));
+            } while (flipped == 0);
+            byte = flipped;
+        }
+        packets.push_back(packet);
+        corrupted.push_back(corrupt);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+
+    // * feed it through a ring in random sized reads, parsing in place
+    usb::RxRing ring(1 << 16);
+    size_t fed = 0;
+    int next = 0, good = 0, bad = 0, wrong = 0;
+    while (fed < stream.size()) {
+        size_t n = std::min<size_t>({1 + rng() % 700, ring.writable(),
+                                     stream.size() - fed});
+        memcpy(ring.write_ptr(), stream.data() + fed, n);
+        ring.commit(n);
+        fed += n;
+
+        while (true) {
+            u8 *frame = ring.read_ptr();
+            u8 *end   = (u8 *)memchr(frame, 0, ring.readable());
+            if (!end) {
+                break;
+            }
+            size_t len = comms::cobs::decode(frame, end - frame);
+            if (len == 0) {
+                bad++;
+            } else {
+                good++;
+                wrong += corrupted[next] || len != packets[next].size() ||
+                         memcmp(frame, packets[next].data(), len) != 0;
+            }
+            next++;
+            ring.consume(end - frame + 1);
+        }
+    }
+
+    int expected_bad = (N_PACKETS + 9) / 10;
+    printf("%d frames decoded, %d dropped (%d corrupted), %d wrong\n", good,
+           bad, expected_bad, wrong);
+    failures += wrong != 0 || good + bad != N_PACKETS ||
+                good != N_PACKETS - expected_bad;
+
+    printf(failures ? "FAILED\n" : "PASSED\n");
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#include "config.hpp"
+#include "field_model.hpp"
+#include "field_tables.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace camera;
+
+constexpr auto POINTS = field_model::sample_lines<FIELD_MODEL_POINTS[0]>();
+constexpr field_model::OccupancyGrid<1> GRID{};
+constexpr field_model::OccupancyGrid<field_tables::CHUNK_SIZE> CHUNK_GRID{};
+
+// the model is symmetric about both axes
+template <int CELL>
+bool symmetric(const field_model::OccupancyGrid<CELL> &grid) {
+    using Grid = field_model::OccupancyGrid<CELL>;
+    for (int j = -Grid::MAX_Y; j <= Grid::MAX_Y; j++) {
+        for (int i = -Grid::MAX_X; i <= Grid::MAX_X; i++) {
+            if (grid.occupied(i, j) != grid.occupied(-i, j) ||
+                grid.occupied(i, j) != grid.occupied(i, -j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    int failures = 0;
+
+    // * every sampled point lies on an occupied cell of the full res grid
+    int off_grid = 0;
+    for (const field_model::Point &point : POINTS) {
+        off_grid += !GRID.occupied(point.x, point.y);
+    }
+    printf("line length %.1f, %d of %zu points off the grid\n",
+           field_model::total_length(), off_grid, POINTS.size());
+    failures += off_grid != 0;
+
+    // * both grids are symmetric, and agree at the chunk scale
+    bool grids_symmetric = symmetric(GRID) && symmetric(CHUNK_GRID);
+    printf("grids symmetric: %s\n", grids_symmetric ? "yes" : "no");
+    failures += !grids_symmetric;
+
+    int chunk_mismatches = 0;
+    for (const field_model::Point &point : POINTS) {
+        chunk_mismatches += !CHUNK_GRID.occupied(
+            field_model::round((double)point.x / field_tables::CHUNK_SIZE),
+            field_model::round((double)point.y / field_tables::CHUNK_SIZE));
+    }
+    printf("%d points outside the chunk grid, %d occupied chunks\n",
+           chunk_mismatches, CHUNK_GRID.count);
+    failures += chunk_mismatches != 0;
+
+    // * rotated tables, distinct points left per level after scaling
+    for (int level = 0; level < field_tables::PYRAMID_LEVELS; level++) {
+        const field_tables::RotatedPoints &points =
+            field_tables::white_lines(0, level);
+        printf("level %d: %d sampled, %d distinct\n", level,
+               FIELD_MODEL_POINTS[level], points.count);
+        failures += points.count == 0;
+    }
+
+    printf(failures ? "FAILED\n" : "PASSED\n");
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#include "field_tables.hpp"
+#include "loss_kernel.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace camera;
+
+const int ROWS   = 480;
+const int COLS   = 640;
+const int N_ITER = 100000;
+
+int main() {
+    // random distance map, values in the clamped range
+    std::vector<uint8_t> distance_map(ROWS * COLS);
+    srand(0);
+    for (auto &d : distance_map) {
+        d = rand() % 21;
+    }
+
+    // * check every kernel matches the scalar one
+    int mismatches = 0;
+    for (int i = 0; i < N_ITER; i++) {
+        const field_tables::RotatedPoints &points =
+            field_tables::white_lines(rand() % field_tables::HEADING_BINS);
+        int32_t row_offset = rand() % 1200 - 360;
+        int32_t col_offset = rand() % 1600 - 480;
+
+        loss_kernel::Accumulator scalar = loss_kernel::sum_scalar(
+            distance_map.data(), COLS, ROWS, COLS, points.x, points.y,
+            points.count, row_offset, col_offset);
+        loss_kernel::Accumulator simd = loss_kernel::sum_simd(
+            distance_map.data(), COLS, ROWS, COLS, points.x, points.y,
+            points.count, row_offset, col_offset);
+
+        if (scalar.distance != simd.distance || scalar.count != simd.count) {
+            mismatches++;
+        }
+    }
+    printf("%s vs scalar: %d / %d mismatches\n", loss_kernel::simd_name(),
+           mismatches, N_ITER);
+
+    // * time both, at poses that keep most points on the image
+    const field_tables::RotatedPoints &points = field_tables::white_lines(45);
+    uint32_t checksum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < N_ITER; i++) {
+        checksum += loss_kernel::sum_scalar(
+                        distance_map.data(), COLS, ROWS, COLS, points.x,
+                        points.y, points.count, ROWS / 2 + i % 32,
+                        COLS / 2 - i % 32)
+                        .distance;
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < N_ITER; i++) {
+        checksum -= loss_kernel::sum_simd(
+                        distance_map.data(), COLS, ROWS, COLS, points.x,
+                        points.y, points.count, ROWS / 2 + i % 32,
+                        COLS / 2 - i % 32)
+                        .distance;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    printf("scalar: %.3f us / pose\n",
+           std::chrono::duration<double, std::micro>(mid - start).count() /
+               N_ITER);
+    printf("%s: %.3f us / pose (checksum %u)\n", loss_kernel::simd_name(),
+           std::chrono::duration<double, std::micro>(end - mid).count() /
+               N_ITER,
+           checksum);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -5,20 +5,40 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
-#include <random>
 #include "pf.hpp"
 
-int main() {
+// odometry after a turn, with no camera input between them, has to move the
+// particles the same way as with one (the robot frame turns with the IMU)
+bool check_turn_then_move(bool camera_between) {
+    ParticleFilter pf(100, -1.0, 1.0, -1.0, 1.0, 1, 1);
+    pf.reinitialize(0.0f, 0.0f, 0.0f, 1e-6f, 0.0f, 1e-6f, 1e-6f);
+
+    pf.push_odometry(10.0f, 0.0f, 1);
+    pf.push_imu(M_PI / 2, 2);
+    if (camera_between) {
+        pf.push_camera(10.0f, 0.0f, M_PI / 2, 3);
+    }
+    pf.push_odometry(10.0f, 0.0f, 4);
+    pf.predict(0.0, 3.0, 0.0);
 
-    std::random_device rd;
-    std::mt19937 rng(rd());
+    // move_kernel: x += dx cos(theta) + dy sin(theta), y += dy cos(theta) - dx sin(theta)
+    Particle estimate = pf.estimate_position();
+    bool ok = std::abs(estimate.x - 10.0f) < 0.5f && std::abs(estimate.y + 10.0f) < 0.5f;
+    std::cout << "Turn then move (camera between: " << camera_between << "): " << estimate.x
+              << " " << estimate.y << ", expected 10 -10" << (ok ? "" : " FAILED") << '\n';
+    return ok;
+}
+
+int main() {
+    if (!check_turn_then_move(false) || !check_turn_then_move(true)) {
+        return 1;
+    }
 
     ParticleFilter pf(5000, -915.0, 915.0, -1215.0, 1215.0); // 100 particles in a 10x10 space
     auto start_time = std::chrono::high_resolution_clock::now();
     auto end_time = std::chrono::high_resolution_clock::now();
     auto elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
     for(int i = 0; i < 1000; i++){
-        pf.added_new_input = false;
         start_time = std::chrono::high_resolution_clock::now();
     
         
@@ -37,9 +57,9 @@ int main() {
         if(i == 0) pf.update_camera(std::make_tuple(4.0-i*0.5, 5.5-i*1.0, M_PI/2));
         if(i%7 != 6){
             pf.update_camera(std::make_tuple(4.0-i*0.5, 5.5-i*1.0, M_PI/2));
-            pf.resample_particles(rng);
+            pf.resample_particles();
         }
-        //pf.resample_particles(rng);
+        //pf.resample_particles();
         
         //Predict values
         
@@ -0,0 +1,110 @@
+#include "config.hpp"
+#include "field.hpp"
+#include "goalpost.hpp"
+#include "pose_prior.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace camera;
+
+const int N_POSES = 10000;
+
+// pass / fail limits, by the number of goals seen
+const float MAX_MEAN_ERROR[3]      = {0.0f, 40.0f, 20.0f}; // field units
+const float MIN_INSIDE_FRACTION[3] = {0.0f, 0.95f, 0.95f};
+
+// the detector, measuring around the image center like the line projection
+GoalpostDetector detector;
+
+/**
+ * @brief What detect_goalposts reports for a goal, seen from a pose
+ * The goal is put in the image with the projection CamProcessor::calculate_loss
+ * matches the field lines with, v = R(heading) (goal + (x, y)) from the image
+ * center, row along v.x, column against v.y. Its angle and distance are then
+ * measured by the detector itself.
+ */
+GoalpostInfo observe(float goal_x, float x, float y, float heading,
+                     std::mt19937 &rng) {
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    float px = goal_x + x, py = GOAL_Y + y;
+    float c = std::cos(heading), s = std::sin(heading);
+    float vx = px * c - py * s, vy = px * s + py * c;
+
+    // bearing and range noise, around the image center
+    float bearing_noise = normal(rng) * GOAL_BEARING_STD;
+    float range_scale   = (1.0f + normal(rng) * GOAL_RANGE_STD) /
+                        GOAL_DISTANCE_SCALE;
+    float nc = std::cos(bearing_noise), ns = std::sin(bearing_noise);
+    float nx = (vx * nc - vy * ns) * range_scale;
+    float ny = (vx * ns + vy * nc) * range_scale;
+
+    cv::Point image_point((int)std::lround(IMG_HEIGHT / 2 - ny),
+                          (int)std::lround(IMG_WIDTH / 2 + nx));
+
+    GoalpostInfo info;
+    info.detected = true;
+    info.midpoint = image_point;
+    info.angle    = detector.findGoalAngle(image_point) + GOALPOST_ANGLE_OFFSET;
+    info.distance = detector.findDistanceToGoal(image_point);
+    return info;
+}
+
+int main() {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    detector.setCenterPoint(cv::Point(IMG_HEIGHT / 2, IMG_WIDTH / 2));
+    bool passed = true;
+
+    // * both goals, then only one, from random poses on the field
+    for (int visible = 2; visible >= 1; visible--) {
+        double sum_error = 0.0, sum_window = 0.0;
+        int valid = 0, inside = 0;
+
+        for (int i = 0; i < N_POSES; i++) {
+            float x = (uniform(rng) - 0.5f) * (field::FIELD_X_SIZE - 20);
+            float y = (uniform(rng) - 0.5f) * (field::FIELD_Y_SIZE - 20);
+            float heading = uniform(rng) * 2 * (float)M_PI;
+
+            std::pair<GoalpostInfo, GoalpostInfo> goalposts = {
+                observe(GOAL_BLUE_X, x, y, heading, rng),
+                observe(GOAL_YELLOW_X, x, y, heading, rng)};
+            if (visible == 1) {
+                goalposts.second.detected = false;
+            }
+
+            // IMU heading, off by its standard deviation
+            PosePrior prior = pose_prior::from_goalposts(
+                goalposts, heading + normal(rng) * POSE_PRIOR_HEADING_STD);
+            if (!prior.valid) {
+                continue;
+            }
+            valid++;
+
+            float error_x = prior.x - x, error_y = prior.y - y;
+            sum_error += std::hypot(error_x, error_y);
+            sum_window += prior.x_window() * prior.y_window() * 4.0;
+            if (std::fabs(error_x) <= prior.x_window() &&
+                std::fabs(error_y) <= prior.y_window()) {
+                inside++;
+            }
+        }
+
+        float mean_error = valid ? sum_error / valid : INFINITY;
+        float inside_fraction = valid ? (float)inside / valid : 0.0f;
+        bool ok = mean_error <= MAX_MEAN_ERROR[visible] &&
+                  inside_fraction >= MIN_INSIDE_FRACTION[visible];
+        passed = passed && ok;
+
+        printf("%d goal(s): %d / %d valid, mean error %.1f (max %.0f), truth "
+               "inside the %.0f sigma box %.1f%% (min %.0f%%), mean box %.0f "
+               "units^2 (field %d)%s\n",
+               visible, valid, N_POSES, mean_error, MAX_MEAN_ERROR[visible],
+               POSE_PRIOR_SIGMAS, 100.0 * inside_fraction,
+               100.0 * MIN_INSIDE_FRACTION[visible], sum_window / valid,
+               field::FIELD_X_SIZE * field::FIELD_Y_SIZE, ok ? "" : " FAILED");
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include "camera.hpp"
+#include "trace.hpp"
+#include "vision_pipeline.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+camera::Camera cam;
+
+int main() {
+    std::mutex latencies_mutex;
+    std::vector<long long> latencies;
+
+    camera::VisionPipeline pipeline([&](const camera::VisionResult &result) {
+        camera::VisionPipeline::publish_to_processor(result);
+
+        std::lock_guard<std::mutex> lock(latencies_mutex);
+        latencies.push_back(result.latency.count());
+    });
+
+    if (!cam.initialize(camera::RES_480P)) {
+        fprintf(stderr, "Failed to initialize camera\n");
+        return 1;
+    }
+
+    pipeline.start();
+    if (!cam.startStreaming([&](camera::FrameHandle frame) {
+            pipeline.submit(std::move(frame));
+        })) {
+        fprintf(stderr, "Failed to start camera capture\n");
+        return 1;
+    }
+
+    printf("Vision pipeline is running. Press Enter to stop...\n");
+    std::cin.get();
+
+    cam.stopCapture();
+    pipeline.stop();
+
+    printf("Submitted: %llu, published: %llu, dropped: %llu\n",
+           (unsigned long long)pipeline.submitted(),
+           (unsigned long long)pipeline.published(),
+           (unsigned long long)pipeline.dropped());
+    printf("Camera frames overwritten: %llu, skipped: %llu\n",
+           (unsigned long long)cam.overwrittenFrames(),
+           (unsigned long long)cam.skippedFrames());
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        printf("Latency (us): p50 %lld, p99 %lld, max %lld\n",
+               latencies[latencies.size() / 2],
+               latencies[latencies.size() * 99 / 100], latencies.back());
+    }
+
+    // per stage latencies, and a trace for chrome://tracing / Perfetto
+    trace::print_histograms();
+    if (trace::dump_chrome_json("./vision_trace.json")) {
+        printf("Trace written to ./vision_trace.json\n");
+    }
+
+    return 0;
+}
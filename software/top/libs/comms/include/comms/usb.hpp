@@ -1,6 +1,7 @@
 #pragma once
 
 #include "comms/default_usb_config.h"
+#include "comms/cobs.hpp"
 #include "identifiers.hpp"
 #include "types.hpp"
 extern "C" {
@@ -25,6 +26,9 @@ extern "C" {
  * INFO:
  * Byte 3: Identifier (u8 enum)
  * The rest is passed to the specific handler.
+ * INFO:
+ * With USB_FRAMING_COBS defined, packets (identifier + data) are sent as
+ * COBS frames with a CRC-16 instead, see comms/cobs.hpp.
  */
 namespace usb {
 
@@ -42,6 +46,10 @@ static const types::u16 MAX_INTERRUPT_TX_BUF_SIZE = MAX_TX_BUF_SIZE * 4;
 static const types::u8 N_LENGTH_BYTES = 2;
 static const types::u16 MAX_RX_PACKET_LENGTH = MAX_RX_BUF_SIZE;
 static const types::u16 MAX_TX_PACKET_LENGTH = MAX_TX_BUF_SIZE;
+static const types::u16 MAX_RX_FRAME_SIZE =
+    comms::cobs::max_frame_size(MAX_RX_PACKET_LENGTH);
+static const types::u16 MAX_TX_FRAME_SIZE =
+    comms::cobs::max_frame_size(MAX_TX_PACKET_LENGTH);
 
 static const types::u16 TUSB_STATUS_CHECKING_TIME = 1; // in milliseconds
 
@@ -94,6 +102,17 @@ struct CurrentRXState {
   }
 };
 
+// COBS framing: bytes of the frame being received, up to its delimiter
+struct FrameRXState {
+  types::u16 frame_len = 0;
+  bool overflowed = false; // frame too long, skipping to the next delimiter
+  types::u8 frame_buffer[MAX_RX_FRAME_SIZE] = {0};
+  inline void reset(void) {
+    frame_len = 0;
+    overflowed = false;
+  }
+};
+
 /* ********** *
  * Main class *
  * ********** */
@@ -184,6 +203,12 @@ public:
                        SemaphoreHandle_t mutex, types::u8 *buffer,
                        types::u16 length);
 
+  /**
+   * @brief number of received frames dropped as corrupt (bad COBS frame or
+   * CRC, or too long), the link resyncs after each
+   */
+  static types::u32 bad_frames(void) { return _bad_frames; }
+
 private:
   /* **************** *
   * Private functions *
@@ -208,6 +233,13 @@ private:
    */
   static void _rx_cb(types::u8 interface, void *args);
 
+  /**
+   * @brief copies a complete packet into its listener's buffer and notifies it
+   * @param packet: identifier, then data
+   * @param packet_len: length including the identifier
+   */
+  static void _dispatch(const types::u8 *packet, types::u16 packet_len);
+
   /**
    * @brief callback to run on change of line coding settings from host
    * @brief used mainly for baud rate reset to bootloader hack
@@ -267,6 +299,11 @@ private:
   // hooks for commands
   TaskHandle_t _tud_task_handle = nullptr;
   static CurrentRXState _current_rx_state;
+  static FrameRXState _frame_rx_state;
+  static types::u32 _bad_frames;
+
+  // COBS framing: frame being encoded by write(), under _write_mutex
+  static types::u8 _tx_frame_buffer[MAX_TX_FRAME_SIZE];
 
   // tusb state
   static EventGroupHandle_t _tusb_state_eventgroup;
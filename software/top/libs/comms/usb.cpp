@@ -35,6 +35,9 @@ types::u8 *CDC::_command_task_buffers[comms::identifier_arr_len] = {nullptr};
 types::u8 CDC::_command_task_buffer_lengths[comms::identifier_arr_len] = {0};
 
 CurrentRXState CDC::_current_rx_state = {};
+FrameRXState CDC::_frame_rx_state = {};
+types::u32 CDC::_bad_frames = 0;
+types::u8 CDC::_tx_frame_buffer[MAX_TX_FRAME_SIZE] = {0};
 
 EventGroupHandle_t CDC::_tusb_state_eventgroup = nullptr;
 
@@ -106,14 +109,31 @@ bool CDC::write(const comms::SendIdentifiers identifier, const u8 *data,
   if (!CDC_connected()) {
     return false;
   }
+#ifdef USB_FRAMING_COBS
+  if (data_len + sizeof(identifier) > MAX_TX_PACKET_LENGTH) {
+    return false;
+  }
   // thread/task safety
   xSemaphoreTake(_write_mutex, portMAX_DELAY);
 
+  // encode the frame, then write it in one go
+  comms::cobs::Encoder encoder(_tx_frame_buffer);
+  encoder.write((u8)identifier);
+  encoder.write(data, data_len);
+  u16 packet_len = encoder.finish();
+  if (tud_cdc_available() < packet_len) {
+    tud_cdc_write_flush(); // NOTE: this blocks (in tinyusb + rp2040), which we want.
+  }
+  tud_cdc_write(_tx_frame_buffer, packet_len);
+#else
   u16 reported_len = data_len + sizeof(identifier);
   u16 packet_len = sizeof(reported_len) + reported_len;
   if (packet_len > MAX_TX_BUF_SIZE) {
     return false;
   }
+  // thread/task safety
+  xSemaphoreTake(_write_mutex, portMAX_DELAY);
+
   if (tud_cdc_available() < packet_len) {
     tud_cdc_write_flush(); // NOTE: this blocks (in tinyusb + rp2040), which we want.
   }
@@ -121,6 +141,7 @@ bool CDC::write(const comms::SendIdentifiers identifier, const u8 *data,
   tud_cdc_write(&reported_len, sizeof(reported_len));
   tud_cdc_write(&identifier, sizeof(identifier));
   tud_cdc_write(data, data_len);
+#endif
 
   tud_cdc_write_flush();
   xSemaphoreGive(_write_mutex);
@@ -132,8 +153,12 @@ bool CDC::write(const comms::SendIdentifiers identifier, const u8 *data,
 bool CDC::write_from_IRQ(const comms::SendIdentifiers identifier,
                          const u8 *data, const u16 data_len,
                          BaseType_t *xHigherPriorityTaskWoken) {
+#ifdef USB_FRAMING_COBS
+  u16 packet_len = comms::cobs::max_frame_size(data_len + sizeof(identifier));
+#else
   u16 reported_len = data_len + sizeof(identifier);
   u16 packet_len = sizeof(reported_len) + reported_len;
+#endif
   // check for remaining space
   if (packet_len > MAX_INTERRUPT_TX_BUF_SIZE - _interrupt_write_buffer_index) {
     return false;
@@ -145,9 +170,17 @@ bool CDC::write_from_IRQ(const comms::SendIdentifiers identifier,
     return false;
   }
   // write to interrupt write buffer
+#ifdef USB_FRAMING_COBS
+  comms::cobs::Encoder encoder(_interrupt_write_buffer +
+                               _interrupt_write_buffer_index);
+  encoder.write((u8)identifier);
+  encoder.write(data, data_len);
+  _interrupt_write_buffer_index += encoder.finish();
+#else
   _interrupt_write_buffer_write(&reported_len, sizeof(reported_len));
   _interrupt_write_buffer_write(&identifier, sizeof(identifier));
   _interrupt_write_buffer_write(data, data_len);
+#endif
 
   xSemaphoreGiveFromISR(_interrupt_write_buffer_mutex,
                         xHigherPriorityTaskWoken);
@@ -193,13 +226,19 @@ bool CDC::printf(const char *format, ...) {
   va_list args;
   va_start(args, format);
   u16 size = vsnprintf(formatted, sizeof(formatted), format, args);
+  va_end(args);
+#ifdef USB_FRAMING_COBS
+  // raw text would only be dropped as a bad frame, send it as debug output
+  size = MIN(size, sizeof(formatted) - 1);
+  return write(comms::SendIdentifiers::COMMS_DEBUG, (u8 *)formatted, size);
+#else
   xSemaphoreTake(_write_mutex, portMAX_DELAY);
   tud_cdc_write(formatted, size);
-  va_end(args);
   tud_cdc_write_flush();
   xSemaphoreGive(_write_mutex);
   taskYIELD(); // let tud_task() run
   return true;
+#endif
 }
 
 void CDC::_usb_device_task(void *args) {
@@ -232,6 +271,133 @@ void CDC::_IRQ_write_flusher(void *args) {
   }
 }
 
+void CDC::_dispatch(const u8 *packet, u16 packet_len) {
+  // packet_len includes the identifier
+  u8 identifier = packet[0];
+
+  // check handler
+  if (!_command_task_handles[identifier]) {
+#ifdef USB_DEBUG_ABSTRACTED
+    comms::CommsErrors err = comms::CommsErrors::CALLING_UNATTACHED_LISTENER;
+    u8 msg[] = {(u8)err, identifier};
+    write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
+#else
+    debug::log("comms::CommsErrors::CALLING_UNATTACHED_LISTENER\n");
+#endif
+    return;
+  }
+
+  // check buffer mutex
+  if (!_command_task_buffer_mutexes[identifier]) {
+#ifdef USB_DEBUG_ABSTRACTED
+    comms::CommsErrors err = comms::CommsErrors::LISTENER_NO_BUFFER_MUTEX;
+    u8 msg[] = {(u8)err, identifier};
+    write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
+#else
+    debug::log("comms::CommsErrors::LISTENER_NO_BUFFER_MUTEX\n");
+#endif
+    return;
+  }
+
+  // check buffer
+  if (!_command_task_buffers[identifier]) {
+#ifdef USB_DEBUG_ABSTRACTED
+    comms::CommsErrors err = comms::CommsErrors::LISTENER_NO_BUFFER;
+    u8 msg[] = {(u8)err, identifier};
+    write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
+#else
+    debug::log("comms::CommsErrors::LISTENER_NO_BUFFER\n");
+#endif
+    return;
+  }
+
+  // check length
+  if (_command_task_buffer_lengths[identifier] < packet_len - 1) {
+#ifdef USB_DEBUG_ABSTRACTED
+    comms::CommsErrors err =
+        comms::CommsErrors::PACKET_RECV_OVER_COMMAND_LISTENER_MAXSIZE;
+    u8 msg[] = {(u8)err, identifier};
+    write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
+#else
+    debug::log(
+        "comms::CommsErrors::PACKET_RECV_OVER_COMMAND_LISTENER_MAXSIZE\n");
+#endif
+    return;
+  }
+
+  // try to grab buffer mutex
+  if (xSemaphoreTake(_command_task_buffer_mutexes[identifier], 0) != pdTRUE) {
+    // mutex is already taken, drop this command
+#ifdef USB_DEBUG_ABSTRACTED
+    comms::CommsWarnings warn =
+        comms::CommsWarnings::LISTENER_BUFFER_MUTEX_HELD;
+    u8 msg[] = {(u8)warn, identifier};
+    write(comms::SendIdentifiers::COMMS_WARN, msg, sizeof(msg));
+#else
+    debug::log("comms::CommsWarnings::LISTENER_BUFFER_MUTEX_HELD\n");
+#endif
+    return;
+  }
+
+  // here we have the buffer mutex
+  // clear the buffer first
+  memset(_command_task_buffers[identifier], 0,
+         _command_task_buffer_lengths[identifier]);
+  // copy command into the buffer, skipping the identifier
+  memcpy(_command_task_buffers[identifier], &packet[sizeof(identifier)],
+         packet_len - sizeof(identifier));
+  // give the semaphore before notifying task, to avoid blocking
+  xSemaphoreGive(_command_task_buffer_mutexes[identifier]);
+  // notify task
+  xTaskNotify(_command_task_handles[identifier], 0, eNoAction);
+}
+
+#ifdef USB_FRAMING_COBS
+// WARN: This does not execute in an interrupt context!
+void CDC::_rx_cb(u8 interface, void *args) {
+  FrameRXState &state = _frame_rx_state;
+  u8 chunk[64];
+
+  // prevention from missing out a command
+  while (tud_cdc_available()) {
+    u32 chunk_len = tud_cdc_read(chunk, sizeof(chunk));
+    const u8 *pos = chunk, *chunk_end = chunk + chunk_len;
+
+    while (pos < chunk_end) {
+      const u8 *delimiter =
+          (const u8 *)memchr(pos, comms::cobs::DELIMITER, chunk_end - pos);
+      const u8 *run_end = delimiter ? delimiter : chunk_end;
+
+      // append the run, or skip it if the frame can no longer fit
+      u16 run_len = run_end - pos;
+      if (state.frame_len + run_len <= MAX_RX_FRAME_SIZE) {
+        memcpy(state.frame_buffer + state.frame_len, pos, run_len);
+        state.frame_len += run_len;
+      } else {
+        state.overflowed = true;
+      }
+      if (!delimiter) {
+        break; // rest of the frame in the next chunk
+      }
+
+      // end of frame: decode in place, dispatch, or count and resync here
+      if (state.overflowed) {
+        _bad_frames++;
+      } else if (state.frame_len > 0) {
+        u16 packet_len =
+            comms::cobs::decode(state.frame_buffer, state.frame_len);
+        if (packet_len) {
+          _dispatch(state.frame_buffer, packet_len);
+        } else {
+          _bad_frames++;
+        }
+      }
+      state.reset();
+      pos = delimiter + 1;
+    }
+  }
+}
+#else
 // WARN: This does not execute in an interrupt context!
 void CDC::_rx_cb(u8 interface, void *args) {
   CurrentRXState &state = _current_rx_state;
@@ -264,8 +430,6 @@ void CDC::_rx_cb(u8 interface, void *args) {
 
     // data bytes
     else {
-      // debug::log("length recieved. expected length: %u\n",
-      //            state.expected_length);
       // wait until there are enough data bytes
       if (tud_cdc_available() < state.expected_length) {
         return;
@@ -274,96 +438,7 @@ void CDC::_rx_cb(u8 interface, void *args) {
       tud_cdc_read(state.data_buffer, state.expected_length);
       // NOTE: here we have a full command in CurrentRXState.
       // this needs to be quickly copied into a command buffer.
-      u8 identifier = state.data_buffer[0];
-      // debug::log("recieved identifier: %u\n", identifier);
-
-      // check handler
-      if (!_command_task_handles[identifier]) {
-#ifdef USB_DEBUG_ABSTRACTED
-        comms::CommsErrors err =
-            comms::CommsErrors::CALLING_UNATTACHED_LISTENER;
-        u8 msg[] = {(u8)err, identifier};
-        write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
-#else
-        debug::log("comms::CommsErrors::CALLING_UNATTACHED_LISTENER\n");
-#endif
-        state.reset();
-        continue;
-      }
-
-      // check buffer mutex
-      if (!_command_task_buffer_mutexes[identifier]) {
-#ifdef USB_DEBUG_ABSTRACTED
-        comms::CommsErrors err = comms::CommsErrors::LISTENER_NO_BUFFER_MUTEX;
-        u8 msg[] = {(u8)err, identifier};
-        write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
-#else
-        debug::log("comms::CommsErrors::LISTENER_NO_BUFFER_MUTEX\n");
-#endif
-        state.reset();
-        continue;
-      }
-
-      // check buffer
-      if (!_command_task_buffers[identifier]) {
-#ifdef USB_DEBUG_ABSTRACTED
-        comms::CommsErrors err = comms::CommsErrors::LISTENER_NO_BUFFER;
-        u8 msg[] = {(u8)err, identifier};
-        write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
-#else
-        debug::log("comms::CommsErrors::LISTENER_NO_BUFFER\n");
-#endif
-        state.reset();
-        continue;
-      }
-
-      // check length
-      if (_command_task_buffer_lengths[identifier] <
-          state.expected_length - 1) {
-#ifdef USB_DEBUG_ABSTRACTED
-        comms::CommsErrors err =
-            comms::CommsErrors::PACKET_RECV_OVER_COMMAND_LISTENER_MAXSIZE;
-        u8 msg[] = {(u8)err, identifier};
-        write(comms::SendIdentifiers::COMMS_ERROR, msg, sizeof(msg));
-#else
-        debug::log(
-            "comms::CommsErrors::PACKET_RECV_OVER_COMMAND_LISTENER_MAXSIZE\n");
-#endif
-        state.reset();
-        continue;
-      }
-
-      // debug::log("trying to grab attached mutex\n");
-      // try to grab buffer mutex
-      if (xSemaphoreTake(_command_task_buffer_mutexes[identifier], 0) !=
-          pdTRUE) {
-        // mutex is already taken, drop this command
-#ifdef USB_DEBUG_ABSTRACTED
-        comms::CommsWarnings warn =
-            comms::CommsWarnings::LISTENER_BUFFER_MUTEX_HELD;
-        u8 msg[] = {(u8)warn, identifier};
-        write(comms::SendIdentifiers::COMMS_WARN, msg, sizeof(msg));
-#else
-        debug::log("comms::CommsWarnings::LISTENER_BUFFER_MUTEX_HELD\n");
-#endif
-        state.reset();
-        continue;
-      }
-      // debug::log("grabbed mutex\n");
-
-      // here we have the buffer mutex
-      // clear the buffer first
-      memset(_command_task_buffers[identifier], 0,
-             _command_task_buffer_lengths[identifier]);
-      // copy command into the buffer
-      // state.data_buffer contains the identifier, so skip that when copying
-      memcpy(_command_task_buffers[identifier],
-             &state.data_buffer[sizeof(identifier)], // skip the identifier
-             sizeof(state.data_buffer) - sizeof(identifier));
-      // give the semaphore before notifying task, to avoid blocking
-      xSemaphoreGive(_command_task_buffer_mutexes[identifier]);
-      // notify task
-      xTaskNotify(_command_task_handles[identifier], 0, eNoAction);
+      _dispatch(state.data_buffer, state.expected_length);
 
       state.reset();
       // NOTE: don't return here, to avoid missing out a command
@@ -371,6 +446,7 @@ void CDC::_rx_cb(u8 interface, void *args) {
     }
   }
 }
+#endif
 
 void CDC::_line_coding_cb(u8 interface, cdc_line_coding_t const *coding,
                           void *args) {